@@ -0,0 +1,33 @@
+# Writes the formula of a ptree with an infection window whose labels are
+# pruned, and checks that it is well formed: every clause ends with its
+# only 0 and the header gives the number of clauses.
+#
+# Usage: cmake -DDIMACS=<exe> -DDATA=<data dir> -DOUT=<output prefix> -P TestDimacsWindow.cmake
+
+execute_process(
+  COMMAND ${DIMACS} -u 1 -i ${DATA}/sample_window.out
+          ${DATA}/sample_window_host.out ${DATA}/sample_window_ptree.out
+          ${OUT}.cnf ${OUT}.var
+  RESULT_VARIABLE result
+  OUTPUT_QUIET )
+if( NOT result EQUAL 0 )
+  message( FATAL_ERROR "dimacs -i failed: ${result}" )
+endif()
+
+file( STRINGS ${OUT}.cnf lines )
+set( nrClauses 0 )
+set( header "" )
+foreach( line IN LISTS lines )
+  if( line MATCHES "^p cnf ([0-9]+) ([0-9]+)$" )
+    set( header ${CMAKE_MATCH_2} )
+  elseif( NOT line MATCHES "^c" )
+    if( NOT line MATCHES "^(-?[1-9][0-9]* )+0$" )
+      message( FATAL_ERROR "malformed clause '${line}' in ${OUT}.cnf" )
+    endif()
+    math( EXPR nrClauses "${nrClauses} + 1" )
+  endif()
+endforeach()
+
+if( NOT header STREQUAL "${nrClauses}" )
+  message( FATAL_ERROR "header of ${OUT}.cnf gives '${header}' clauses, but it has ${nrClauses}" )
+endif()
@@ -0,0 +1,49 @@
+# Runs unigenparser on the UniGen samples of the sample instance and
+# compares its output with the expected transmission trees and summary.
+#
+# Usage: cmake -DUNIGENPARSER=<exe> -DDATA=<data dir> -DOUT=<output prefix> -P TestUnigenParser.cmake
+
+# compare the output of the last run with the expected output
+function( compare_output run )
+  foreach( output summary ttrees )
+    execute_process(
+      COMMAND ${CMAKE_COMMAND} -E compare_files ${OUT}_${output}.out ${DATA}/sample_unigen_${output}.out
+      RESULT_VARIABLE result )
+    if( NOT result EQUAL 0 )
+      message( FATAL_ERROR "unigenparser ${run}: ${output} differs from ${DATA}/sample_unigen_${output}.out" )
+    endif()
+  endforeach()
+endfunction()
+
+# with chunks of at least 1 byte, every line of the samples is a chunk, so
+# that the chunks are merged in order and a solution is merged across chunks
+foreach( chunk 1048576 1 )
+  foreach( threads 1 2 4 )
+    execute_process(
+      COMMAND ${UNIGENPARSER} -j ${threads} -chunk ${chunk} -S ${OUT}_summary.out
+              ${DATA}/sample_host.out ${DATA}/sample_ptree.out ${DATA}/sample_varlist.out
+              ${DATA}/sample_unigen.out ${OUT}_ttrees.out
+      RESULT_VARIABLE result
+      OUTPUT_QUIET )
+    if( NOT result EQUAL 0 )
+      message( FATAL_ERROR "unigenparser -j ${threads} -chunk ${chunk} failed: ${result}" )
+    endif()
+
+    compare_output( "-j ${threads} -chunk ${chunk}" )
+  endforeach()
+endforeach()
+
+# samples that are piped in can not be memory-mapped
+execute_process(
+  COMMAND ${CMAKE_COMMAND} -E cat ${DATA}/sample_unigen.out
+  COMMAND ${UNIGENPARSER} -S ${OUT}_summary.out
+          ${DATA}/sample_host.out ${DATA}/sample_ptree.out ${DATA}/sample_varlist.out
+          /dev/stdin ${OUT}_ttrees.out
+  RESULTS_VARIABLE results
+  OUTPUT_QUIET )
+list( GET results 1 result )
+if( NOT result EQUAL 0 )
+  message( FATAL_ERROR "unigenparser on /dev/stdin failed: ${result}" )
+endif()
+
+compare_output( "on /dev/stdin" )
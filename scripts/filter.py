@@ -15,7 +15,9 @@ alpha = float(sys.argv[3])
 df_summary = pd.read_csv(summary_filename, sep="\t")
 df_summary = df_summary.sort_values(["unsampledLineages", "transmissions"])
 
-cut_off = int(alpha * len(df_summary))
+# every row is a distinct solution, weighted by the number of times it was sampled
+cumulative_count = df_summary["count"].cumsum()
+cut_off = int((cumulative_count < alpha * cumulative_count.iloc[-1]).sum())
 solIndices = set(df_summary["solIdx"][:cut_off+1])
 
 with open(ttrees_filename) as f:
@@ -25,7 +27,7 @@ with open(ttrees_filename) as f:
     while printedTrees < len(solIndices):
         s = f.readline().rstrip("\n").split()
         numEdges = int(s[0])
-        solIdx = int(s[-1])
+        solIdx = int(s[4].rstrip(","))
         if solIdx in solIndices:
             printedTrees += 1
             print(" ".join(s))
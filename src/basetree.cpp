@@ -518,6 +518,42 @@ bool BaseTree::readInfectionWindow(std::istream& in)
 		return true;
 }
 
+void BaseTree::copyHostsAndContactMap(const BaseTree& B)
+{
+		_hostLabel = B._hostLabel;
+		_nhosts = B._nhosts;
+		_unshosts = B._unshosts;
+		_enttime = B._enttime;
+		_remtime = B._remtime;
+		_totalTime = B._totalTime;
+		_maxInf = B._maxInf;
+		_hostInfectionWindow = B._hostInfectionWindow;
+		
+		for (int i = 0; i < _nhosts; ++i)
+		{
+				Node u = _contactMap.addNode();
+				_contactNodeToIndex[u] = i;
+				_contactIndexToNode.push_back(u);
+				_contactNodeToId[u] = _hostLabel[i];
+				_contactIdToNode[_hostLabel[i]] = u;
+		}
+		
+		// add the arcs in the order of their ids to preserve the arc iteration order
+		const Digraph& C = B._contactMap;
+		for (int id = 0; id <= C.maxArcId(); ++id)
+		{
+				Arc est = C.arcFromId(id);
+				if (!C.valid(est))
+						continue;
+				
+				Node s = _contactIndexToNode[B._contactNodeToIndex[C.source(est)]];
+				Node t = _contactIndexToNode[B._contactNodeToIndex[C.target(est)]];
+				
+				Arc a = _contactMap.addArc(s, t);
+				_contactArcToNumStrains[a] = B._contactArcToNumStrains[est];
+		}
+}
+
 void BaseTree::setFullContactMap()
 {
 		for (int i = 0; i < _nhosts; ++i)
@@ -707,6 +743,63 @@ bool BaseTree::readPtree(std::istream& in, bool binaryTree)
     return true;
 }
 
+Node BaseTree::insertLeaf(Node v, double parentTime, double leafTime, int hostLabel)
+{
+		if (hostLabel < 0 || hostLabel >= _nhosts)
+		{
+				std::cerr << "Error: host label " << hostLabel + 1 << " out of bounds" << std::endl;
+				return lemon::INVALID;
+		}
+
+		Node p = parent(v);
+		if (parentTime > _timestamp[v] || leafTime < parentTime || (p != lemon::INVALID && parentTime < _timestamp[p]))
+		{
+				std::cerr << "Error: time " << parentTime << " of grafted node is inconsistent with node " << _nodeToId[v] << std::endl;
+				return lemon::INVALID;
+		}
+
+		if (_enttime[hostLabel] > leafTime || _remtime[hostLabel] < leafTime)
+		{
+				std::cerr << "Error: leaf time " << leafTime << " outside the window of host " << _hostLabel[hostLabel] << std::endl;
+				return lemon::INVALID;
+		}
+
+		// a tree with n nodes has n - 1 arcs, so the new indices follow on directly
+		int idx = _indexToNode.size();
+		int arcIdx = idx - 1;
+
+		Node leaf = _tree.addNode();
+		_label[leaf] = hostLabel;
+		_timestamp[leaf] = leafTime;
+		_nodeToId[leaf] = std::to_string(idx + 1);
+		_nodeToIndex[leaf] = idx;
+		_indexToNode.push_back(leaf);
+		_idToNode[std::to_string(idx + 1)] = leaf;
+
+		// internal nodes are labeled -1 in the ptree file, read as -2
+		Node w = _tree.addNode();
+		_label[w] = -2;
+		_timestamp[w] = parentTime;
+		_nodeToId[w] = std::to_string(idx + 2);
+		_nodeToIndex[w] = idx + 1;
+		_indexToNode.push_back(w);
+		_idToNode[std::to_string(idx + 2)] = w;
+
+		if (p == lemon::INVALID)
+		{
+				_root = w;
+		}
+		else
+		{
+				_tree.changeTarget(InArcIt(_tree, v), w);
+		}
+
+		_arcToIndex[_tree.addArc(w, v)] = arcIdx;
+		_arcToIndex[_tree.addArc(w, leaf)] = arcIdx + 1;
+
+		return leaf;
+}
+
 int BaseTree::getMu(const IntNodeMap& l) const
 {
   int mu = 0;
@@ -834,6 +927,92 @@ void BaseTree::readInputWithHostsTransmissionTree(std::istream& hfile,
 }
 
 
+NodeVector BaseTree::getPreOrder() const
+{
+  NodeVector order;
+  NodeList stack(1, _root);
+  
+  while (!stack.empty())
+  {
+    Node u = stack.back();
+    stack.pop_back();
+    order.push_back(u);
+    
+    // push in reverse so that the first child is visited first
+    NodeVector children;
+    for (OutArcIt a(_tree, u); a != lemon::INVALID; ++a)
+    {
+      children.push_back(_tree.target(a));
+    }
+    stack.insert(stack.end(), children.rbegin(), children.rend());
+  }
+  
+  return order;
+}
+
+NodeVector BaseTree::getPostOrder() const
+{
+  NodeVector order;
+  
+  // a node is emitted once its children have been emitted
+  std::vector<std::pair<Node, OutArcIt>> stack(1, std::make_pair(_root, OutArcIt(_tree, _root)));
+  while (!stack.empty())
+  {
+    OutArcIt& a = stack.back().second;
+    if (a == lemon::INVALID)
+    {
+      order.push_back(stack.back().first);
+      stack.pop_back();
+    }
+    else
+    {
+      Node v = _tree.target(a);
+      ++a;
+      stack.push_back(std::make_pair(v, OutArcIt(_tree, v)));
+    }
+  }
+  
+  return order;
+}
+
+bool BaseTree::unsampledHostsInterchangeable() const
+{
+  const int first = _nhosts - _unshosts;
+  
+  BoolMatrix contact(_nhosts, BoolVector(_nhosts, false));
+  for (ArcIt est(_contactMap); est != lemon::INVALID; ++est)
+  {
+    contact[_contactNodeToIndex[_contactMap.source(est)]][_contactNodeToIndex[_contactMap.target(est)]] = true;
+  }
+  
+  for (int a = first; a < _nhosts; ++a)
+  {
+    if (infectionWindowExists(a))
+      return false;
+    
+    if (_enttime[a] != _enttime[first] || _remtime[a] != _remtime[first])
+      return false;
+    
+    if (a == first)
+      continue;
+    
+    // the transposition of first and a must preserve the contact map
+    if (contact[first][a] != contact[a][first])
+      return false;
+    
+    for (int x = 0; x < _nhosts; ++x)
+    {
+      if (x != first && x != a)
+      {
+        if (contact[first][x] != contact[a][x] || contact[x][first] != contact[x][a])
+          return false;
+      }
+    }
+  }
+  
+  return true;
+}
+
 int BaseTree::getGamma(const IntNodeMap& l) const
 {
   return getN(l).size();
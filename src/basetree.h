@@ -44,6 +44,22 @@ public:
 		
 		/// read infection window file
 		bool readInfectionWindow(std::istream& in);
+		
+		/// copy the hosts, contact map and infection windows of another tree
+		/// so that several ptrees can share them without reparsing
+		void copyHostsAndContactMap(const BaseTree& B);
+		
+		/// graft a new leaf onto the tree by subdividing the arc entering v
+		/// (or above the root) with a new internal node. Returns the new leaf,
+		/// or lemon::INVALID if the times or the host label are infeasible.
+		/// New nodes are named after the existing ones, so the written ptree
+		/// is no longer guaranteed to be in post-order.
+		///
+		/// @param v Node whose incoming arc is subdivided
+		/// @param parentTime Time of the new internal node
+		/// @param leafTime Time of the new leaf
+		/// @param hostLabel Host of the new leaf
+		Node insertLeaf(Node v, double parentTime, double leafTime, int hostLabel);
     
     /// write Ptree with no strings attached
     void writePtree(std::ostream& out) const;
@@ -302,6 +318,19 @@ public:
     /// Return minimum co-transmission network
     ArcMatrix getN(const IntNodeMap& l) const;
   
+    /// Return the nodes of the tree in pre-order
+    /// (children are visited in the order of their outgoing arcs)
+    NodeVector getPreOrder() const;
+    
+    /// Return the nodes of the tree in post-order
+    /// (children are visited in the order of their outgoing arcs)
+    NodeVector getPostOrder() const;
+    
+    /// Decide whether the unsampled hosts are interchangeable, i.e. they have
+    /// the same entry and removal times, no infection windows, and every
+    /// permutation of them is an automorphism of the contact map
+    bool unsampledHostsInterchangeable() const;
+  
     /// Decides whether the given set of nodes is connected
     ///
     /// @param nodes Node set
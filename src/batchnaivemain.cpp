@@ -0,0 +1,302 @@
+/*
+ * batchnaivemain.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: P. Sashittal
+ */
+
+#include "utils.h"
+#include "naive.h"
+#include "basetree.h"
+#include "transmissionstats.h"
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <lemon/arg_parser.h>
+
+/// Stream buffer that discards everything written to it
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c)
+    {
+        return c;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    std::string host_filename, ptrees_filename, output_prefix;
+    int rootLabel = 0;
+    int nrUnsampledHosts = 0;
+    int sampleLimit = 0;
+    int nrThreads = std::thread::hardware_concurrency();
+    int seed = 0;
+    bool exactStats = false;
+		std::string contactmap_filename;
+
+    lemon::ArgParser ap(argc, argv);
+    ap.refOption("r", "Root label (default: 0)", rootLabel);
+		ap.refOption("m", "Contact map file: (default: empty)", contactmap_filename);
+    ap.refOption("u", "Number of unsampled hosts (default: 0)", nrUnsampledHosts);
+    ap.refOption("l", "Number of samples per ptree (default: 0)", sampleLimit);
+    ap.refOption("j", "Number of threads (default: number of cores)", nrThreads);
+    ap.refOption("s", "Random number generator seed (default: 0)", seed);
+    ap.refOption("e", "Exact transmission pair statistics (default: false)", exactStats);
+    ap.other("<host>");
+    ap.other("<ptrees>");
+    ap.other("<output_prefix>");
+    ap.parse();
+
+    if (ap.files().size() != 3)
+    {
+        std::cerr << "Error1: expected <host> <ptrees> <output_prefix>" << std::endl;
+        return 1;
+    }
+
+    host_filename = ap.files()[0];
+    ptrees_filename = ap.files()[1];
+    output_prefix = ap.files()[2];
+
+    std::ifstream host_file(host_filename.c_str());
+    if (!host_file.good())
+    {
+        std::cerr << "Error2: failed opening '" << host_filename << "' for reading" << std::endl;
+        return 1;
+    }
+
+    std::ifstream ptrees_file(ptrees_filename.c_str());
+    if (!ptrees_file.good())
+    {
+        std::cerr << "Error3: failed opening '" << ptrees_filename << "' for reading" << std::endl;
+        return 1;
+    }
+
+		std::ifstream contactmap_file;
+		if (!contactmap_filename.empty())
+		{
+				contactmap_file.open(contactmap_filename.c_str());
+				if (!contactmap_file.good())
+				{
+						std::cerr << "Error 4: failed openning '" << contactmap_filename << "' for reading" << std::endl;
+						return 1;
+				}
+		}
+
+		// the hosts and the contact map are read once and shared by all ptrees
+    BaseTree H;
+		H.setUnHosts(nrUnsampledHosts);
+		H.readHost(host_file);
+		if (!contactmap_filename.empty())
+		{
+				if (!H.readContactMap(contactmap_file))
+				{
+						return 1;
+				}
+				contactmap_file.close();
+		}
+		else
+		{
+				H.setFullContactMap();
+		}
+    host_file.close();
+
+		const int nrInfectedHosts = H.getNrHost();
+
+		if (nrThreads < 1)
+		{
+				nrThreads = 1;
+		}
+
+		// shared state: the ptree stream, per-tree counts and
+		// the number of samples in which each transmission pair occurs
+		std::mutex inputMutex;
+		std::mutex resultMutex;
+		int nrTrees = 0;
+		bool inputError = false;
+		UInt64Vector treeCounts;
+		UInt64Matrix pairSamples(nrInfectedHosts, UInt64Vector(nrInfectedHosts, 0));
+		uint64_t totalSamples = 0;
+		TransmissionStats stats(nrInfectedHosts);
+
+		auto worker = [&]()
+		{
+				UInt64Matrix localPairSamples(nrInfectedHosts, UInt64Vector(nrInfectedHosts, 0));
+				uint64_t localSamples = 0;
+				TransmissionStats localStats(nrInfectedHosts);
+				
+				// the progress reported by the solvers of this thread is discarded
+				NullBuffer nullBuffer;
+				std::ostream nullStream(&nullBuffer);
+
+				while (true)
+				{
+						std::unique_ptr<BaseTree> pB(new BaseTree());
+						int treeIdx;
+
+						{
+								std::lock_guard<std::mutex> lock(inputMutex);
+
+								if (inputError || !ptrees_file.good() || ptrees_file.peek() == EOF)
+								{
+										break;
+								}
+
+								pB->copyHostsAndContactMap(H);
+
+								// ptrees are separated by an empty line
+								if (!pB->readPtree(ptrees_file, true))
+								{
+										inputError = true;
+										break;
+								}
+
+								treeIdx = nrTrees++;
+						}
+
+						const BaseTree& B = *pB;
+						Naive solver(B, rootLabel - 1, nullStream);
+						solver.initContact();
+						uint64_t nsols = solver.countContactSolutions(nullStream);
+						
+						if (nsols > 0 && exactStats)
+						{
+								solver.accumulateTransmissionStats(localStats);
+						}
+
+						if (nsols > 0 && sampleLimit > 0)
+						{
+								std::mt19937 rng(seed + treeIdx);
+								solver.setRandomGenerator(rng);
+
+								const Digraph& G = B.tree();
+								BoolMatrix used(nrInfectedHosts, BoolVector(nrInfectedHosts));
+
+								for (int count = 0; count < sampleLimit; ++count)
+								{
+										solver.getContactSample();
+										const IntNodeMap& ell = solver.getSolMap();
+
+										for (int s = 0; s < nrInfectedHosts; ++s)
+										{
+												std::fill(used[s].begin(), used[s].end(), false);
+										}
+
+										for (ArcIt a(G); a != lemon::INVALID; ++a)
+										{
+												int s = ell[G.source(a)];
+												int t = ell[G.target(a)];
+
+												if (s != t && !used[s][t])
+												{
+														used[s][t] = true;
+														++localPairSamples[s][t];
+												}
+										}
+
+										++localSamples;
+								}
+						}
+
+						{
+								std::lock_guard<std::mutex> lock(resultMutex);
+
+								if (treeCounts.size() <= treeIdx)
+								{
+										treeCounts.resize(treeIdx + 1);
+								}
+								treeCounts[treeIdx] = nsols;
+						}
+				}
+
+				// reduce the per-thread sample counts and statistics
+				std::lock_guard<std::mutex> lock(resultMutex);
+				stats.merge(localStats);
+				for (int s = 0; s < nrInfectedHosts; ++s)
+				{
+						for (int t = 0; t < nrInfectedHosts; ++t)
+						{
+								pairSamples[s][t] += localPairSamples[s][t];
+						}
+				}
+				totalSamples += localSamples;
+		};
+
+		std::vector<std::thread> threads;
+		for (int i = 0; i < nrThreads; ++i)
+		{
+				threads.push_back(std::thread(worker));
+		}
+		for (std::thread& thread : threads)
+		{
+				thread.join();
+		}
+
+		ptrees_file.close();
+
+		if (inputError)
+		{
+				std::cerr << "Error5: failed reading ptree " << nrTrees << " from '" << ptrees_filename << "'" << std::endl;
+				return 1;
+		}
+
+		std::cout << "number of ptrees is: " << nrTrees << std::endl;
+
+		std::string counts_filename = output_prefix + "counts.out";
+		std::ofstream outCounts(counts_filename.c_str());
+		if (!outCounts.good())
+		{
+				std::cerr << "Error6: failed opening '" << counts_filename << "' for writing" << std::endl;
+				return 1;
+		}
+
+		outCounts << "treeIdx\tcount" << std::endl;
+		for (int idx = 0; idx < nrTrees; ++idx)
+		{
+				outCounts << idx << "\t" << treeCounts[idx] << std::endl;
+		}
+		outCounts.close();
+
+		if (exactStats)
+		{
+				std::string stats_filename = output_prefix + "transmissions.out";
+				std::ofstream outStats(stats_filename.c_str());
+				if (!outStats.good())
+				{
+						std::cerr << "Error8: failed opening '" << stats_filename << "' for writing" << std::endl;
+						return 1;
+				}
+				
+				stats.writeStats(outStats, H);
+				outStats.close();
+		}
+
+		if (sampleLimit > 0)
+		{
+				std::string marginals_filename = output_prefix + "marginals.out";
+				std::ofstream outMarginals(marginals_filename.c_str());
+				if (!outMarginals.good())
+				{
+						std::cerr << "Error7: failed opening '" << marginals_filename << "' for writing" << std::endl;
+						return 1;
+				}
+
+				// fraction of all samples (over all ptrees) in which s infects t
+				outMarginals << "source\ttarget\tfrequency" << std::endl;
+				for (int s = 0; s < nrInfectedHosts; ++s)
+				{
+						for (int t = 0; t < nrInfectedHosts; ++t)
+						{
+								if (pairSamples[s][t] > 0)
+								{
+										outMarginals << H.getContactName(s) << "\t" << H.getContactName(t) << "\t"
+																 << double(pairSamples[s][t]) / double(totalSamples) << std::endl;
+								}
+						}
+				}
+				outMarginals.close();
+		}
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * clausearena.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: P. Sashittal
+ */
+
+#ifndef CLAUSEARENA_H
+#define CLAUSEARENA_H
+
+#include "utils.h"
+
+/// This class stores CNF clauses in a single literal array,
+/// clause i ends at _clauseEnd[i] and starts where clause i - 1 ends
+class ClauseArena
+{
+public:
+    ClauseArena()
+        : _literals()
+        , _clauseEnd()
+        , _firstAuxVar(1)
+        , _nrAuxVars(0)
+    {
+    }
+
+    /// set the index of the first auxiliary variable
+    void setFirstAuxVar(int firstAuxVar)
+    {
+        _firstAuxVar = firstAuxVar;
+    }
+
+    /// Return a new auxiliary variable
+    int newVar()
+    {
+        return _firstAuxVar + _nrAuxVars++;
+    }
+
+    /// Return number of auxiliary variables
+    int getNrAuxVars() const
+    {
+        return _nrAuxVars;
+    }
+
+    /// renumber the auxiliary variables, starting at firstAuxVar
+    void renumberAuxVars(int firstAuxVar)
+    {
+        const int shift = firstAuxVar - _firstAuxVar;
+        if (shift == 0 || _nrAuxVars == 0)
+        {
+            _firstAuxVar = firstAuxVar;
+            return;
+        }
+
+        for (int& lit : _literals)
+        {
+            if (lit >= _firstAuxVar)
+            {
+                lit += shift;
+            }
+            else if (-lit >= _firstAuxVar)
+            {
+                lit -= shift;
+            }
+        }
+        _firstAuxVar = firstAuxVar;
+    }
+
+    /// append a clause
+    void add(std::initializer_list<int> literals)
+    {
+        add(literals.begin(), literals.end());
+    }
+
+    /// append a clause
+    void add(const IntVector& literals)
+    {
+        add(literals.data(), literals.data() + literals.size());
+    }
+
+    /// append the clause [first, last)
+    void add(const int* first, const int* last)
+    {
+        _literals.insert(_literals.end(), first, last);
+        _clauseEnd.push_back(_literals.size());
+    }
+
+    /// append all clauses of another arena
+    void append(const ClauseArena& other)
+    {
+        size_t offset = _literals.size();
+        _literals.insert(_literals.end(), other._literals.begin(), other._literals.end());
+        for (size_t end : other._clauseEnd)
+        {
+            _clauseEnd.push_back(offset + end);
+        }
+    }
+
+    /// reserve space for nrClauses clauses with nrLiterals literals in total
+    void reserve(size_t nrClauses, size_t nrLiterals)
+    {
+        _clauseEnd.reserve(nrClauses);
+        _literals.reserve(nrLiterals);
+    }
+
+    /// remove all clauses and auxiliary variables
+    void clear()
+    {
+        _literals.clear();
+        _clauseEnd.clear();
+        _nrAuxVars = 0;
+    }
+
+    /// Return number of clauses
+    size_t size() const
+    {
+        return _clauseEnd.size();
+    }
+
+    /// Return pointer to the first literal of clause i
+    const int* begin(size_t i) const
+    {
+        return _literals.data() + (i == 0 ? 0 : _clauseEnd[i - 1]);
+    }
+
+    /// Return pointer past the last literal of clause i
+    const int* end(size_t i) const
+    {
+        return _literals.data() + _clauseEnd[i];
+    }
+
+    /// write the clauses in DIMACS format
+    void write(std::ostream& out) const
+    {
+        // format the literals by hand, each clause followed by "0" and a newline
+        std::string buffer;
+        buffer.reserve(1 << 17);
+        char digits[12];
+
+        size_t first = 0;
+        for (size_t last : _clauseEnd)
+        {
+            for (size_t i = first; i < last; ++i)
+            {
+                int lit = _literals[i];
+                unsigned int x = lit < 0 ? -static_cast<unsigned int>(lit) : lit;
+
+                int n = 0;
+                do
+                {
+                    digits[n++] = '0' + x % 10;
+                    x /= 10;
+                } while (x > 0);
+
+                if (lit < 0)
+                {
+                    buffer.push_back('-');
+                }
+                while (n > 0)
+                {
+                    buffer.push_back(digits[--n]);
+                }
+                buffer.push_back(' ');
+            }
+            buffer.append("0\n", 2);
+            first = last;
+
+            if (buffer.size() >= (1 << 16))
+            {
+                out.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+
+        out.write(buffer.data(), buffer.size());
+    }
+
+protected:
+    /// literals of all clauses
+    IntVector _literals;
+    /// end offset of every clause
+    std::vector<size_t> _clauseEnd;
+    /// index of the first auxiliary variable
+    int _firstAuxVar;
+    /// number of auxiliary variables
+    int _nrAuxVars;
+};
+
+#endif // CLAUSEARENA_H
@@ -0,0 +1,290 @@
+/*
+ * cnfsimplifier.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: P. Sashittal
+ */
+
+#include "cnfsimplifier.h"
+
+CnfSimplifier::CnfSimplifier(const ClauseArena& clauses, int nrVars, int nrProtectedVars)
+    : _clauses()
+    , _nrVars(nrVars)
+    , _nrProtectedVars(nrProtectedVars)
+    , _value(nrVars + 1, 0)
+    , _occurrences(2 * nrVars + 2)
+    , _satisfied()
+    , _nrOpen()
+    , _queue()
+    , _newIndex(nrVars + 1, 0)
+    , _nrNewVars(0)
+    , _result()
+{
+    // remove duplicate literals and tautologies, mark[var] is the
+    // literal of var in the current clause
+    IntVector mark(nrVars + 1, 0);
+    IntVector clause;
+
+    for (size_t i = 0; i < clauses.size(); ++i)
+    {
+        clause.clear();
+        bool tautology = false;
+
+        for (const int* lit = clauses.begin(i); lit != clauses.end(i); ++lit)
+        {
+            int var = abs(*lit);
+            if (mark[var] == -*lit)
+            {
+                tautology = true;
+            }
+            else if (mark[var] == 0)
+            {
+                mark[var] = *lit;
+                clause.push_back(*lit);
+            }
+        }
+
+        for (const int* lit = clauses.begin(i); lit != clauses.end(i); ++lit)
+        {
+            mark[abs(*lit)] = 0;
+        }
+
+        if (!tautology)
+        {
+            _clauses.add(clause);
+        }
+    }
+}
+
+bool CnfSimplifier::simplify()
+{
+    const int nrClauses = _clauses.size();
+
+    _satisfied = BoolVector(nrClauses, false);
+    _nrOpen = IntVector(nrClauses, 0);
+
+    for (int c = 0; c < nrClauses; ++c)
+    {
+        for (const int* lit = _clauses.begin(c); lit != _clauses.end(c); ++lit)
+        {
+            _occurrences[litIndex(*lit)].push_back(c);
+        }
+        _nrOpen[c] = _clauses.end(c) - _clauses.begin(c);
+
+        if (_nrOpen[c] == 0)
+        {
+            return false;
+        }
+        else if (_nrOpen[c] == 1 && !assign(*_clauses.begin(c)))
+        {
+            return false;
+        }
+    }
+
+    if (!propagate())
+    {
+        return false;
+    }
+
+    eliminatePureLiterals();
+    renumber();
+
+    return true;
+}
+
+bool CnfSimplifier::assign(int lit)
+{
+    int var = abs(lit);
+    int value = lit > 0 ? 1 : -1;
+
+    if (_value[var] != 0)
+    {
+        return _value[var] == value;
+    }
+
+    _value[var] = value;
+    _queue.push_back(lit);
+
+    return true;
+}
+
+bool CnfSimplifier::propagate()
+{
+    while (!_queue.empty())
+    {
+        int lit = _queue.back();
+        _queue.pop_back();
+
+        for (int c : _occurrences[litIndex(lit)])
+        {
+            _satisfied[c] = true;
+        }
+
+        for (int c : _occurrences[litIndex(-lit)])
+        {
+            if (_satisfied[c])
+            {
+                continue;
+            }
+
+            --_nrOpen[c];
+            if (_nrOpen[c] == 0)
+            {
+                return false;
+            }
+            else if (_nrOpen[c] == 1)
+            {
+                // the clause is unit unless a literal is true but not yet propagated
+                int unit = 0;
+                for (const int* l = _clauses.begin(c); l != _clauses.end(c); ++l)
+                {
+                    int value = _value[abs(*l)];
+                    if (value == 0)
+                    {
+                        unit = *l;
+                    }
+                    else if ((value > 0) == (*l > 0))
+                    {
+                        unit = 0;
+                        break;
+                    }
+                }
+
+                if (unit != 0 && !assign(unit))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void CnfSimplifier::eliminatePureLiterals()
+{
+    const int nrClauses = _clauses.size();
+
+    // number of positive and negative occurrences in clauses that are not satisfied
+    IntVector nrPos(_nrVars + 1, 0);
+    IntVector nrNeg(_nrVars + 1, 0);
+
+    for (int c = 0; c < nrClauses; ++c)
+    {
+        if (_satisfied[c])
+        {
+            continue;
+        }
+
+        for (const int* lit = _clauses.begin(c); lit != _clauses.end(c); ++lit)
+        {
+            if (_value[abs(*lit)] == 0)
+            {
+                ++(*lit > 0 ? nrPos : nrNeg)[abs(*lit)];
+            }
+        }
+    }
+
+    IntVector pure;
+    for (int var = _nrProtectedVars + 1; var <= _nrVars; ++var)
+    {
+        if (_value[var] == 0 && (nrPos[var] == 0) != (nrNeg[var] == 0))
+        {
+            pure.push_back(var);
+        }
+    }
+
+    // setting a pure literal only satisfies clauses, which can make
+    // further variables pure
+    while (!pure.empty())
+    {
+        int var = pure.back();
+        pure.pop_back();
+
+        if (_value[var] != 0 || (nrPos[var] > 0 && nrNeg[var] > 0))
+        {
+            continue;
+        }
+
+        int lit = nrPos[var] > 0 ? var : -var;
+        _value[var] = lit > 0 ? 1 : -1;
+
+        for (int c : _occurrences[litIndex(lit)])
+        {
+            if (_satisfied[c])
+            {
+                continue;
+            }
+            _satisfied[c] = true;
+
+            for (const int* l = _clauses.begin(c); l != _clauses.end(c); ++l)
+            {
+                int other = abs(*l);
+                if (other == var || _value[other] != 0)
+                {
+                    continue;
+                }
+
+                int& count = (*l > 0 ? nrPos : nrNeg)[other];
+                --count;
+                if (count == 0 && other > _nrProtectedVars)
+                {
+                    pure.push_back(other);
+                }
+            }
+        }
+    }
+}
+
+void CnfSimplifier::renumber()
+{
+    const int nrClauses = _clauses.size();
+
+    // variables outside the independent support are kept if they still occur
+    BoolVector used(_nrVars + 1, false);
+    for (int var = 1; var <= _nrProtectedVars; ++var)
+    {
+        used[var] = true;
+    }
+
+    for (int c = 0; c < nrClauses; ++c)
+    {
+        if (!_satisfied[c])
+        {
+            for (const int* lit = _clauses.begin(c); lit != _clauses.end(c); ++lit)
+            {
+                used[abs(*lit)] = true;
+            }
+        }
+    }
+
+    _nrNewVars = 0;
+    for (int var = 1; var <= _nrVars; ++var)
+    {
+        if (_value[var] == 0 && used[var])
+        {
+            _newIndex[var] = ++_nrNewVars;
+        }
+    }
+
+    _result.clear();
+    IntVector clause;
+    for (int c = 0; c < nrClauses; ++c)
+    {
+        if (_satisfied[c])
+        {
+            continue;
+        }
+
+        clause.clear();
+        for (const int* lit = _clauses.begin(c); lit != _clauses.end(c); ++lit)
+        {
+            int var = abs(*lit);
+            if (_value[var] == 0)
+            {
+                clause.push_back(*lit > 0 ? _newIndex[var] : -_newIndex[var]);
+            }
+        }
+        _result.add(clause);
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * cnfsimplifier.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: P. Sashittal
+ */
+
+#ifndef CNFSIMPLIFIER_H
+#define CNFSIMPLIFIER_H
+
+#include "utils.h"
+#include "clausearena.h"
+
+/// This class simplifies a CNF formula by unit propagation and pure literal
+/// elimination, and renumbers the remaining variables. Variables 1 to
+/// nrProtectedVars form the independent support: they are never eliminated
+/// as pure literals and are kept (as the first variables) unless they are
+/// fixed, so that the projected models of the formula are unchanged.
+class CnfSimplifier
+{
+public:
+    /// constructor
+    ///
+    /// @param clauses Clauses of the formula
+    /// @param nrVars Number of variables
+    /// @param nrProtectedVars Number of variables in the independent support
+    CnfSimplifier(const ClauseArena& clauses, int nrVars, int nrProtectedVars);
+
+    /// simplify the formula, returns false if it is unsatisfiable
+    bool simplify();
+
+    /// Return value of a variable (1 true, -1 false, 0 not fixed)
+    int getValue(int var) const
+    {
+        return _value[var];
+    }
+
+    /// Return index of a variable in the simplified formula (0 if removed)
+    int getNewIndex(int var) const
+    {
+        return _newIndex[var];
+    }
+
+    /// Return number of variables of the simplified formula
+    int getNrVars() const
+    {
+        return _nrNewVars;
+    }
+
+    /// Return clauses of the simplified formula
+    const ClauseArena& getClauses() const
+    {
+        return _result;
+    }
+
+protected:
+    /// assign the literal true, returns false on a conflict
+    bool assign(int lit);
+
+    /// propagate the assigned literals, returns false on a conflict
+    bool propagate();
+
+    /// eliminate the pure literals of variables outside the independent support
+    void eliminatePureLiterals();
+
+    /// renumber the variables and collect the remaining clauses
+    void renumber();
+
+    /// Return position of a literal in the occurrence lists
+    int litIndex(int lit) const
+    {
+        return lit > 0 ? 2 * lit : 2 * -lit + 1;
+    }
+
+    /// input clauses (without duplicate literals and tautologies)
+    ClauseArena _clauses;
+    /// number of variables
+    int _nrVars;
+    /// number of variables in the independent support
+    int _nrProtectedVars;
+    /// value of every variable
+    IntVector _value;
+    /// clauses of every literal
+    IntMatrix _occurrences;
+    /// satisfied clauses
+    BoolVector _satisfied;
+    /// number of literals of every clause that are not false
+    IntVector _nrOpen;
+    /// assigned literals that are not yet propagated
+    IntVector _queue;
+    /// new index of every variable
+    IntVector _newIndex;
+    /// number of variables of the simplified formula
+    int _nrNewVars;
+    /// clauses of the simplified formula
+    ClauseArena _result;
+};
+
+#endif // CNFSIMPLIFIER_H
@@ -0,0 +1,414 @@
+/*
+ * decisioncounter.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: P. Sashittal
+ */
+
+#include "decisioncounter.h"
+
+DecisionCounter::DecisionCounter(const ClauseArena& clauses,
+                                 int nrVars,
+                                 const IntVector& order,
+                                 size_t maxCacheSize)
+    : _clauses(clauses)
+    , _nrVars(nrVars)
+    , _rank(nrVars + 1, -1)
+    , _maxCacheSize(maxCacheSize)
+    , _occurrences(2 * nrVars + 2)
+    , _value(nrVars + 1, 0)
+    , _trail()
+    , _cache()
+    , _varMark(nrVars + 1, 0)
+    , _clauseMark(clauses.size(), 0)
+    , _mark(0)
+    , _conflict(false)
+    , _aborted(false)
+    , _overflow(false)
+{
+    for (int i = 0; i < order.size(); ++i)
+    {
+        _rank[order[i]] = i;
+    }
+
+    for (int c = 0; c < _clauses.size(); ++c)
+    {
+        for (const int* lit = _clauses.begin(c); lit != _clauses.end(c); ++lit)
+        {
+            _occurrences[litIndex(*lit)].push_back(c);
+        }
+    }
+
+    // unit clauses hold in every model
+    for (int c = 0; c < _clauses.size() && !_conflict; ++c)
+    {
+        const int size = _clauses.end(c) - _clauses.begin(c);
+        if (size == 0)
+        {
+            _conflict = true;
+        }
+        else if (size == 1)
+        {
+            int lit = *_clauses.begin(c);
+            if (_value[abs(lit)] == 0)
+            {
+                _conflict = !propagate(lit);
+            }
+            else
+            {
+                _conflict = (_value[abs(lit)] > 0) != (lit > 0);
+            }
+        }
+    }
+}
+
+bool DecisionCounter::count(uint64_t& nrModels)
+{
+    nrModels = 0;
+    if (_conflict)
+    {
+        return true;
+    }
+
+    IntVector vars;
+    for (int var = 1; var <= _nrVars; ++var)
+    {
+        vars.push_back(var);
+    }
+
+    std::vector<Component> components;
+    IntVector freeVars;
+    split(vars, components, freeVars);
+
+    uint64_t res = 1;
+    for (size_t i = 0; i < freeVars.size(); ++i)
+    {
+        res = multiply(res, 2);
+    }
+    for (const Component& component : components)
+    {
+        if (res == 0 || _aborted)
+        {
+            break;
+        }
+        res = multiply(res, count(component));
+    }
+
+    nrModels = res;
+    return !_aborted && !_overflow;
+}
+
+void DecisionCounter::sample(std::mt19937& rng, IntVector& solution)
+{
+    const size_t trailSize = _trail.size();
+
+    IntVector vars;
+    for (int var = 1; var <= _nrVars; ++var)
+    {
+        vars.push_back(var);
+    }
+
+    std::vector<Component> components;
+    IntVector freeVars;
+    split(vars, components, freeVars);
+
+    std::uniform_int_distribution<int> coin(0, 1);
+    for (int var : freeVars)
+    {
+        _value[var] = coin(rng) ? 1 : -1;
+        _trail.push_back(var);
+    }
+    for (const Component& component : components)
+    {
+        sample(component, rng);
+    }
+
+    solution.clear();
+    for (int var = 1; var <= _nrVars; ++var)
+    {
+        if (_rank[var] != -1)
+        {
+            solution.push_back(_value[var] > 0 ? var : -var);
+        }
+    }
+
+    undo(trailSize);
+}
+
+uint64_t DecisionCounter::count(const Component& component)
+{
+    IntVector key(component.clauses);
+    key.push_back(-1);
+    key.insert(key.end(), component.vars.begin(), component.vars.end());
+
+    auto it = _cache.find(key);
+    if (it != _cache.end())
+    {
+        return it->second;
+    }
+
+    if (_cache.size() >= _maxCacheSize)
+    {
+        _aborted = true;
+    }
+    if (_aborted)
+    {
+        return 0;
+    }
+
+    // branch on the first independent variable in the order, without
+    // independent variables the component is only checked for satisfiability
+    int branchVar = 0;
+    for (int var : component.vars)
+    {
+        if (_rank[var] != -1 && (branchVar == 0 || _rank[var] < _rank[branchVar]))
+        {
+            branchVar = var;
+        }
+    }
+
+    uint64_t res = 0;
+    if (branchVar != 0)
+    {
+        res = add(countBranch(component, branchVar), countBranch(component, -branchVar));
+    }
+    else
+    {
+        branchVar = component.vars.front();
+        res = countBranch(component, branchVar) > 0 || countBranch(component, -branchVar) > 0 ? 1 : 0;
+    }
+
+    if (!_aborted)
+    {
+        _cache[key] = res;
+    }
+
+    return res;
+}
+
+uint64_t DecisionCounter::countBranch(const Component& component, int lit)
+{
+    const size_t trailSize = _trail.size();
+
+    uint64_t res = 0;
+    if (propagate(lit))
+    {
+        std::vector<Component> components;
+        IntVector freeVars;
+        split(component.vars, components, freeVars);
+
+        res = 1;
+        for (size_t i = 0; i < freeVars.size(); ++i)
+        {
+            res = multiply(res, 2);
+        }
+        for (const Component& subComponent : components)
+        {
+            if (res == 0 || _aborted)
+            {
+                break;
+            }
+            res = multiply(res, count(subComponent));
+        }
+    }
+
+    undo(trailSize);
+
+    return res;
+}
+
+void DecisionCounter::sample(const Component& component, std::mt19937& rng)
+{
+    int branchVar = 0;
+    for (int var : component.vars)
+    {
+        if (_rank[var] != -1 && (branchVar == 0 || _rank[var] < _rank[branchVar]))
+        {
+            branchVar = var;
+        }
+    }
+
+    if (branchVar == 0)
+    {
+        return;
+    }
+
+    // choose the branch with probability proportional to its count
+    uint64_t nrTrue = countBranch(component, branchVar);
+    uint64_t nrFalse = countBranch(component, -branchVar);
+    assert(nrTrue + nrFalse > 0);
+
+    std::uniform_int_distribution<uint64_t> dist(0, nrTrue + nrFalse - 1);
+    int lit = dist(rng) < nrTrue ? branchVar : -branchVar;
+
+    bool res = propagate(lit);
+    assert(res);
+    (void)res;
+
+    std::vector<Component> components;
+    IntVector freeVars;
+    split(component.vars, components, freeVars);
+
+    std::uniform_int_distribution<int> coin(0, 1);
+    for (int var : freeVars)
+    {
+        _value[var] = coin(rng) ? 1 : -1;
+        _trail.push_back(var);
+    }
+    for (const Component& subComponent : components)
+    {
+        sample(subComponent, rng);
+    }
+}
+
+bool DecisionCounter::propagate(int lit)
+{
+    size_t next = _trail.size();
+
+    _value[abs(lit)] = lit > 0 ? 1 : -1;
+    _trail.push_back(abs(lit));
+
+    while (next < _trail.size())
+    {
+        int var = _trail[next++];
+        int falseLit = _value[var] > 0 ? -var : var;
+
+        for (int c : _occurrences[litIndex(falseLit)])
+        {
+            int unit = 0;
+            int nrOpen = 0;
+            bool satisfied = false;
+
+            for (const int* l = _clauses.begin(c); l != _clauses.end(c); ++l)
+            {
+                int value = _value[abs(*l)];
+                if (value == 0)
+                {
+                    unit = *l;
+                    ++nrOpen;
+                }
+                else if ((value > 0) == (*l > 0))
+                {
+                    satisfied = true;
+                    break;
+                }
+            }
+
+            if (satisfied || nrOpen > 1)
+            {
+                continue;
+            }
+            else if (nrOpen == 0)
+            {
+                return false;
+            }
+
+            _value[abs(unit)] = unit > 0 ? 1 : -1;
+            _trail.push_back(abs(unit));
+        }
+    }
+
+    return true;
+}
+
+void DecisionCounter::undo(size_t trailSize)
+{
+    while (_trail.size() > trailSize)
+    {
+        _value[_trail.back()] = 0;
+        _trail.pop_back();
+    }
+}
+
+void DecisionCounter::split(const IntVector& vars,
+                            std::vector<Component>& components,
+                            IntVector& freeVars)
+{
+    ++_mark;
+
+    for (int root : vars)
+    {
+        if (_value[root] != 0 || _varMark[root] == _mark)
+        {
+            continue;
+        }
+
+        // breadth-first search over the clauses that are not satisfied
+        Component component;
+        component.vars.push_back(root);
+        _varMark[root] = _mark;
+
+        for (size_t i = 0; i < component.vars.size(); ++i)
+        {
+            int var = component.vars[i];
+            for (int lit : {var, -var})
+            {
+                for (int c : _occurrences[litIndex(lit)])
+                {
+                    if (_clauseMark[c] == _mark || isSatisfied(c))
+                    {
+                        continue;
+                    }
+                    _clauseMark[c] = _mark;
+                    component.clauses.push_back(c);
+
+                    for (const int* l = _clauses.begin(c); l != _clauses.end(c); ++l)
+                    {
+                        int other = abs(*l);
+                        if (_value[other] == 0 && _varMark[other] != _mark)
+                        {
+                            _varMark[other] = _mark;
+                            component.vars.push_back(other);
+                        }
+                    }
+                }
+            }
+        }
+
+        if (component.clauses.empty())
+        {
+            if (_rank[root] != -1)
+            {
+                freeVars.push_back(root);
+            }
+            continue;
+        }
+
+        std::sort(component.vars.begin(), component.vars.end());
+        std::sort(component.clauses.begin(), component.clauses.end());
+        components.push_back(component);
+    }
+}
+
+bool DecisionCounter::isSatisfied(int c) const
+{
+    for (const int* l = _clauses.begin(c); l != _clauses.end(c); ++l)
+    {
+        int value = _value[abs(*l)];
+        if (value != 0 && (value > 0) == (*l > 0))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t DecisionCounter::multiply(uint64_t a, uint64_t b)
+{
+    uint64_t res;
+    if (__builtin_mul_overflow(a, b, &res))
+    {
+        _overflow = true;
+    }
+    return res;
+}
+
+uint64_t DecisionCounter::add(uint64_t a, uint64_t b)
+{
+    uint64_t res;
+    if (__builtin_add_overflow(a, b, &res))
+    {
+        _overflow = true;
+    }
+    return res;
+}
@@ -0,0 +1,125 @@
+/*
+ * decisioncounter.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: P. Sashittal
+ */
+
+#ifndef DECISIONCOUNTER_H
+#define DECISIONCOUNTER_H
+
+#include "utils.h"
+#include "clausearena.h"
+
+/// This class counts and uniformly samples the models of a CNF formula
+/// projected on its independent support. It is an exhaustive DPLL search
+/// that branches on the independent variables in a given order, splits
+/// the remaining formula into connected components and caches the count
+/// of every component, i.e. it implicitly compiles the formula into a
+/// decision-DNNF. Components without independent variables are only
+/// checked for satisfiability.
+class DecisionCounter
+{
+public:
+    /// constructor
+    ///
+    /// @param clauses Clauses of the formula
+    /// @param nrVars Number of variables
+    /// @param order Independent variables in branching order
+    /// @param maxCacheSize Maximum number of cached components
+    DecisionCounter(const ClauseArena& clauses,
+                    int nrVars,
+                    const IntVector& order,
+                    size_t maxCacheSize);
+
+    /// count the projected models, returns false if the cache exceeds its
+    /// maximum size or the count does not fit in 64 bits
+    bool count(uint64_t& nrModels);
+
+    /// sample a projected model uniformly (count must have succeeded)
+    ///
+    /// @param solution Literals of the independent variables in increasing order
+    void sample(std::mt19937& rng, IntVector& solution);
+
+    /// Return number of cached components
+    size_t getCacheSize() const
+    {
+        return _cache.size();
+    }
+
+protected:
+    /// a connected component of the remaining formula
+    struct Component
+    {
+        /// unassigned variables (increasing)
+        IntVector vars;
+        /// clauses that are not satisfied (increasing)
+        IntVector clauses;
+    };
+
+    /// Return number of projected models of a component
+    uint64_t count(const Component& component);
+
+    /// count the models of the component after assigning lit
+    uint64_t countBranch(const Component& component, int lit);
+
+    /// sample the independent variables of a component
+    void sample(const Component& component, std::mt19937& rng);
+
+    /// assign lit and propagate, returns false on a conflict
+    bool propagate(int lit);
+
+    /// undo the assignments made after the trail had size trailSize
+    void undo(size_t trailSize);
+
+    /// split the unassigned variables of vars into components
+    ///
+    /// @param freeVars Independent variables that are in no clause
+    void split(const IntVector& vars,
+               std::vector<Component>& components,
+               IntVector& freeVars);
+
+    /// Return whether clause c is satisfied
+    bool isSatisfied(int c) const;
+
+    /// multiply with overflow check
+    uint64_t multiply(uint64_t a, uint64_t b);
+
+    /// add with overflow check
+    uint64_t add(uint64_t a, uint64_t b);
+
+    /// Return position of a literal in the occurrence lists
+    int litIndex(int lit) const
+    {
+        return lit > 0 ? 2 * lit : 2 * -lit + 1;
+    }
+
+    /// clauses
+    ClauseArena _clauses;
+    /// number of variables
+    int _nrVars;
+    /// rank of every independent variable in the branching order (-1 otherwise)
+    IntVector _rank;
+    /// maximum number of cached components
+    size_t _maxCacheSize;
+    /// clauses of every literal
+    IntMatrix _occurrences;
+    /// value of every variable (1 true, -1 false, 0 unassigned)
+    IntVector _value;
+    /// assigned variables in assignment order
+    IntVector _trail;
+    /// counts of components keyed by their clauses and variables
+    IntVectorToUInt64HashMap _cache;
+    /// visit marks of variables and clauses used by split
+    IntVector _varMark;
+    IntVector _clauseMark;
+    int _mark;
+    /// the formula is unsatisfiable by unit propagation
+    bool _conflict;
+    /// the cache exceeded its maximum size
+    bool _aborted;
+    /// a count does not fit in 64 bits
+    bool _overflow;
+};
+
+#endif // DECISIONCOUNTER_H
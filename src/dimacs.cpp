@@ -6,6 +6,18 @@
  */
 
 #include "dimacs.h"
+#include "cnfsimplifier.h"
+#include "decisioncounter.h"
+#include "varmap.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <sys/stat.h>
+#include <unistd.h>
 
 Dimacs::Dimacs(const BaseTree& T,
                const int rootLabel,
@@ -14,11 +26,43 @@ Dimacs::Dimacs(const BaseTree& T,
     : _T(T)
 		, _rootLabel(rootLabel)
 		, _bottleneck(false)
+		, _symmetryBreaking(false)
     , _Rv(_T.tree())
 		, _Rst()
-		, _solFile(psol.c_str())
-    , _varFile(varlist.c_str())
+		, _solFile(psol == "-" ? "/dev/stdout" : psol.c_str())
+    , _varFile()
+		, _solFilename(psol)
+		, _embedVarList(varlist == "-")
+		, _streamClauses(false)
+		, _clauseOut(nullptr)
+		, _keepClauses(false)
+		, _preprocess(false)
+		, _pruneLabels(true)
+		, _splitComponents(false)
+		, _exactCount(false)
+		, _nrSamples(0)
+		, _seed(0)
+		, _shard(1)
+		, _nrShards(1)
+		, _supportFormat(SUPPORT_UNIGEN)
+		, _labelWeight(_T.tree())
+		, _orderFilename()
+		, _varMapFilename()
+		, _baseCacheDir()
+		, _baseFilename()
+		, _baseNrClauses(0)
+		, _numClauses(0)
+		, _nrThreads(1)
+		, _firstAuxVar(0)
+		, _amoEncoding(AMO_SEQUENTIAL)
+		, _amoThreshold(8)
+		, _numVertexVar(0)
+		, _feasibleLabels(_T.tree())
 {
+		if (!_embedVarList)
+		{
+				_varFile.open(varlist.c_str());
+		}
 }
 
 bool Dimacs::solveDimacs()
@@ -59,6 +103,21 @@ bool Dimacs::solveDimacs()
         }
     }
 		
+		if (_symmetryBreaking)
+		{
+				if (!_T.unsampledHostsInterchangeable())
+				{
+						std::cerr << "unsampled hosts are not interchangeable" << std::endl;
+						return false;
+				}
+				
+				if (_rootLabel >= nrInfectedHosts - _T.getUnHosts())
+				{
+						std::cerr << "root label can not be an unsampled host" << std::endl;
+						return false;
+				}
+		}
+		
     initVariables();
 		
 		for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
@@ -76,205 +135,1313 @@ bool Dimacs::solveDimacs()
 				}
 		}
     
-    writeVariableList();
+		initLists();
+		
+		// the clauses that do not depend on the contact map are read from
+		// the base formula cache, and the contact variables are numbered
+		// after their auxiliary variables
+		if (!_baseCacheDir.empty() && !prepareBaseFormula())
+		{
+				return false;
+		}
+		
+		// with preprocessing, the variable list and the independent support
+		// are written with the variables of the simplified formula, when the
+		// formula is split every component has its own independent support
+		if (!_preprocess)
+		{
+				writeVariableList();
+				writeVariableOrder();
+				if (!writeBinaryVariableMap())
+				{
+						return false;
+				}
+		}
+		
+		// unless they are kept in memory, the clauses are streamed to a
+		// temporary file, as the header with the number of clauses precedes them.
+		// Standard output and pipes are written in two passes instead, the
+		// first only counting the clauses.
+		struct stat solStat;
+		_streamClauses = !_keepClauses
+				&& (_solFilename == "-" || stat(_solFilename.c_str(), &solStat) != 0 || !S_ISREG(solStat.st_mode));
+		
+		if (!_keepClauses && !_streamClauses)
+		{
+				_clauseFilename = _solFilename + ".clauses";
+				_clauseFile.open(_clauseFilename.c_str(), std::ios::binary);
+				if (!_clauseFile.good())
+				{
+						std::cerr << "error: failed opening '" << _clauseFilename << "' for writing" << std::endl;
+						return false;
+				}
+		}
+		_arena.clear();
+		_numClauses = 0;
+		reserveClauses();
+		
+		// the merge tool renumbers the auxiliary variables of every shard
+		// after the _numVar variables shared by all shards
+		if (_nrShards > 1)
+		{
+				_solFile << "c shard " << _shard << " " << _nrShards << " " << _numVar << std::endl;
+		}
 		
     // write independent support
-    writeIndependentSupport();
-    std::cout << "independent support written" << std::endl;
+		if (!_preprocess && !_splitComponents)
+		{
+				writeIndependentSupport();
+				std::cout << "independent support written" << std::endl;
+		}
+		
+		// the constraint families are split into tasks that are run
+		// concurrently, their clauses are written in this order
+		using namespace std::placeholders;
+		std::vector<ClauseTask> tasks;
+		
+		// the arcs of the quadratic families in this shard
+		const int nrArcs = _arcs.size();
+		const int firstArc = static_cast<int>(static_cast<int64_t>(nrArcs) * (_shard - 1) / _nrShards);
+		const int lastArc = static_cast<int>(static_cast<int64_t>(nrArcs) * _shard / _nrShards);
+		auto arcSlice = [this, firstArc](void (Dimacs::*write)(ClauseArena&, int, int)) {
+				return [this, firstArc, write](ClauseArena& arena, int first, int last) {
+						(this->*write)(arena, firstArc + first, firstArc + last);
+				};
+		};
+		const bool firstShard = _shard == 1;
+		const bool baseFamilies = firstShard && _baseCacheDir.empty();
+		
+		if (baseFamilies)
+		{
+				// vertex label time constraints
+				addClauseTasks(tasks, _nodes.size(),
+											 std::bind(&Dimacs::writeVertexTimeConstraints, this, _1, _2, _3),
+											 "vertex time constraints written");
+		}
+		
+		if (firstShard)
+		{
+				// vertex label contact map constraints
+				addClauseTasks(tasks, _nodes.size(),
+											 std::bind(&Dimacs::writeVertexContactConstraints, this, _1, _2, _3),
+											 "vertex contact constraints written");
+		}
 		
-    // vertex label time constraints
-    writeVertexTimeConstraints();
-    std::cout<< "vertex time constraints written" << std::endl;
-  
-		// vertex label contact map constraints
-		writeVertexContactConstraints();
-		std::cout << "vertex contact constraints written" << std::endl;
-
 		// infection edge time constraint
-		writeInfectionTimeConstraints();
-		std::cout << "infection time constraint written" << std::endl;
+		addClauseTasks(tasks, lastArc - firstArc,
+									 arcSlice(&Dimacs::writeInfectionTimeConstraints),
+									 "infection time constraint written");
 		
-		// infection window constraints
-		writeInfectionWindowConstraints();
-		std::cout << "infection window constraints written" << std::endl;
+		if (baseFamilies)
+		{
+				// infection window constraints
+				tasks.push_back({std::bind(&Dimacs::writeInfectionWindowConstraints, this, _1),
+												 "infection window constraints written"});
+		}
 		
 		if (_bottleneck)
 		{
-				writeStrongBottleneckCosntraints();
-				std::cout << "strong bottleneck constraint written" << std::endl;
+				addClauseTasks(tasks, lastArc - firstArc,
+											 arcSlice(&Dimacs::writeStrongBottleneckCosntraints),
+											 "strong bottleneck constraint written");
 		}
 		
-		// direct infection constraints
-		if (_rootLabel > -1)
+		if (firstShard)
 		{
-				writeRootedDirectInfectionConstraints(_rootLabel);
+				// direct infection constraints
+				if (_rootLabel > -1)
+				{
+						tasks.push_back({std::bind(&Dimacs::writeRootedDirectInfectionConstraints, this, _1, _rootLabel),
+														 "direct infection constraint written"});
+				}
+				else
+				{
+						tasks.push_back({std::bind(&Dimacs::writeUnRootedDirectInfectionConstraint, this, _1),
+														 "direct infection constraint written"});
+				}
+				
+				if (_symmetryBreaking)
+				{
+						tasks.push_back({std::bind(&Dimacs::writeSymmetryBreakingConstraints, this, _1),
+														 "symmetry breaking constraints written"});
+				}
 		}
-		else
+		
+		if (_streamClauses)
 		{
-				writeUnRootedDirectInfectionConstraint();
+				int numVar = _numVar;
+				_clauseOut = nullptr;
+				runClauseTasks(tasks);
+				
+				_solFile << "p cnf " << _numVar << " " << _numClauses + _baseNrClauses << std::endl;
+				writeBaseClauses();
+				
+				_numVar = numVar;
+				_numClauses = 0;
+				_clauseOut = &_solFile;
+				runClauseTasks(tasks);
+				
+				_solFile.close();
+				return true;
 		}
-		std::cout << "direct infection constraint written" << std::endl;
-  
-    _solFile << "p cnf " << _numVar << " " << _clauses.size() << std::endl;
+		
+		_clauseOut = &_clauseFile;
+		runClauseTasks(tasks);
   
-    for (auto clause : _clauses)
-    {
-        for (auto var : clause)
-        {
-          _solFile << var << " ";
-        }
-        _solFile << "0" << std::endl;
-    }
+		if (!_keepClauses)
+		{
+				_clauseFile.close();
+		}
+		
+		if (_preprocess)
+		{
+				if (!simplifyClauses())
+				{
+						return false;
+				}
+				
+				writeVariableList();
+				writeVariableOrder();
+				if (!writeBinaryVariableMap())
+				{
+						return false;
+				}
+		}
+		
+		if (_exactCount)
+		{
+				countExactly();
+		}
+		
+		if (_splitComponents)
+		{
+				bool res = writeComponents();
+				_solFile.close();
+				return res;
+		}
+		
+		if (_preprocess)
+		{
+				writeIndependentSupport();
+				std::cout << "independent support written" << std::endl;
+		}
+		
+    _solFile << "p cnf " << _numVar << " " << _numClauses + _baseNrClauses << std::endl;
+		writeBaseClauses();
+		
+		if (_keepClauses)
+		{
+				_arena.write(_solFile);
+		}
+		else
+		{
+				std::ifstream clauseFile(_clauseFilename.c_str(), std::ios::binary);
+				if (_numClauses > 0)
+				{
+						_solFile << clauseFile.rdbuf();
+				}
+				clauseFile.close();
+				std::remove(_clauseFilename.c_str());
+		}
+		
     _solFile.close();
     
     return true;
 }
 
-void Dimacs::initVariables()
+uint64_t Dimacs::getBaseFormulaHash() const
 {
-    if (!_solFile.good())
-    {
-        std::cerr << "error: failed opening solution file" << std::endl;
-    }
-    if (!_varFile.good())
-    {
-        std::cerr << "error: failed opening solution file" << std::endl;
-    }
-    
-    const Digraph& G = tree();
-		const Digraph& C = contactMap();
-    const int nrInfectedHosts = _T.getNrHost();
-    
-    // init vertex variables
-    for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
-    {
-        _Rv[vi] = IntVector(nrInfectedHosts, 0);
-    }
-    
-    int rank = 1;
-    
-    for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
-    {
-				if (vi != root() || _rootLabel == -1)
+		const Digraph& G = tree();
+		const int nrInfectedHosts = _T.getNrHost();
+		
+		// 64-bit FNV-1a over everything the base clauses are generated from
+		uint64_t hash = 14695981039346656037ULL;
+		auto combine = [&hash](uint64_t value) {
+				for (int i = 0; i < 8; ++i)
+				{
+						hash ^= (value >> (8 * i)) & 0xff;
+						hash *= 1099511628211ULL;
+				}
+		};
+		auto combineTime = [&combine](double value) {
+				uint64_t bits;
+				std::memcpy(&bits, &value, sizeof(bits));
+				combine(bits);
+		};
+		
+		// version of the base formula
+		combine(1);
+		combine(_amoEncoding);
+		combine(_amoThreshold);
+		combine(nrInfectedHosts);
+		
+		combine(_nodes.size());
+		for (Node vi : _nodes)
+		{
+				combine(index(vi));
+				combine(lemon::countOutArcs(G, vi) == 0 ? label(vi) : -1);
+				for (int s = 0; s < nrInfectedHosts; ++s)
+				{
+						combine(_Rv[vi][s]);
+				}
+		}
+		
+		for (int s = 0; s < nrInfectedHosts; ++s)
+		{
+				combine(_T.infectionWindowExists(s));
+				if (_T.infectionWindowExists(s))
+				{
+						combineTime(_T.getInfectionWindow(s));
+						combineTime(_T.getRemTime(s));
+				}
+		}
+		
+		for (ArcIt eij(G); eij != lemon::INVALID; ++eij)
+		{
+				combine(index(G.source(eij)));
+				combine(index(G.target(eij)));
+				combineTime(time(G.source(eij)));
+				combineTime(time(G.target(eij)));
+		}
+		
+		return hash;
+}
+
+bool Dimacs::prepareBaseFormula()
+{
+		std::ostringstream filename;
+		const uint64_t hash = getBaseFormulaHash();
+		filename << _baseCacheDir << "/base-" << std::hex << std::setw(16) << std::setfill('0') << hash << ".cnf";
+		_baseFilename = filename.str();
+		
+		std::ifstream baseFile(_baseFilename.c_str());
+		if (!baseFile.good())
+		{
+				if (!writeBaseFormula(hash))
+				{
+						return false;
+				}
+				baseFile.open(_baseFilename.c_str());
+		}
+		else
+		{
+				std::cout << "base formula read from '" << _baseFilename << "'" << std::endl;
+		}
+		
+		// header "c base <hash> <vertex variables> <auxiliary variables> <clauses>"
+		std::string c, base, hashString;
+		int nrVertexVars = -1;
+		int nrAuxVars = 0;
+		baseFile >> c >> base >> hashString >> nrVertexVars >> nrAuxVars >> _baseNrClauses;
+		if (!baseFile.good() || c != "c" || base != "base" || nrVertexVars != _numVertexVar)
+		{
+				std::cerr << "error: '" << _baseFilename << "' is not a base formula of this input" << std::endl;
+				return false;
+		}
+		
+		const int nrInfectedHosts = _T.getNrHost();
+		for (int s = 0; s < nrInfectedHosts; ++s)
+		{
+				for (int t = 0; t < nrInfectedHosts; ++t)
+				{
+						if (_Rst[s][t] > 0)
+						{
+								_Rst[s][t] += nrAuxVars;
+						}
+				}
+		}
+		_numVar += nrAuxVars;
+		
+		return true;
+}
+
+bool Dimacs::writeBaseFormula(uint64_t hash)
+{
+		using namespace std::placeholders;
+		
+		// written to temporary files that are renamed, so that concurrent
+		// runs never read a partial base formula
+		std::ostringstream suffix;
+		suffix << "." << getpid();
+		const std::string clauseFilename = _baseFilename + ".clauses" + suffix.str();
+		const std::string tmpFilename = _baseFilename + suffix.str();
+		
+		std::ofstream clauseFile(clauseFilename.c_str(), std::ios::binary);
+		if (!clauseFile.good())
+		{
+				std::cerr << "error: failed opening '" << clauseFilename << "' for writing" << std::endl;
+				return false;
+		}
+		
+		std::vector<ClauseTask> tasks;
+		addClauseTasks(tasks, _nodes.size(),
+									 std::bind(&Dimacs::writeVertexTimeConstraints, this, _1, _2, _3),
+									 "vertex time constraints written");
+		tasks.push_back({std::bind(&Dimacs::writeInfectionWindowConstraints, this, _1),
+										 "infection window constraints written"});
+		
+		// the auxiliary variables of the base formula follow the vertex variables
+		const int numVar = _numVar;
+		_numVar = _numVertexVar;
+		_numClauses = 0;
+		_clauseOut = &clauseFile;
+		runClauseTasks(tasks);
+		clauseFile.close();
+		
+		std::ofstream tmpFile(tmpFilename.c_str(), std::ios::binary);
+		tmpFile << "c base " << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec << " " << _numVertexVar << " "
+						<< _numVar - _numVertexVar << " " << _numClauses << std::endl;
+		std::ifstream clauses(clauseFilename.c_str(), std::ios::binary);
+		if (_numClauses > 0)
+		{
+				tmpFile << clauses.rdbuf();
+		}
+		clauses.close();
+		tmpFile.close();
+		std::remove(clauseFilename.c_str());
+		
+		_numVar = numVar;
+		_numClauses = 0;
+		_clauseOut = nullptr;
+		
+		if (!tmpFile || std::rename(tmpFilename.c_str(), _baseFilename.c_str()) != 0)
+		{
+				std::cerr << "error: failed writing '" << _baseFilename << "'" << std::endl;
+				std::remove(tmpFilename.c_str());
+				return false;
+		}
+		
+		std::cout << "base formula written to '" << _baseFilename << "'" << std::endl;
+		
+		return true;
+}
+
+void Dimacs::writeBaseClauses()
+{
+		if (_baseFilename.empty())
+		{
+				return;
+		}
+		
+		std::ifstream baseFile(_baseFilename.c_str(), std::ios::binary);
+		std::string header;
+		getline(baseFile, header);
+		if (_baseNrClauses > 0)
+		{
+				_solFile << baseFile.rdbuf();
+		}
+}
+
+void Dimacs::addClauseTasks(std::vector<ClauseTask>& tasks, int nrItems,
+														std::function<void(ClauseArena&, int, int)> write,
+														const std::string& message)
+{
+		// small chunks bound the memory of the clauses not yet written
+		const int chunkSize = 64;
+		
+		for (int first = 0; first < nrItems; first += chunkSize)
+		{
+				int last = std::min(first + chunkSize, nrItems);
+				tasks.push_back({std::bind(write, std::placeholders::_1, first, last),
+												 last == nrItems ? message : ""});
+		}
+		
+		if (nrItems == 0)
+		{
+				tasks.push_back({[](ClauseArena&) {}, message});
+		}
+}
+
+void Dimacs::runClauseTasks(const std::vector<ClauseTask>& tasks)
+{
+		const int nrTasks = tasks.size();
+		
+		// every task numbers its auxiliary variables from _firstAuxVar,
+		// they are renumbered in task order when the clauses are written
+		_firstAuxVar = _numVar + 1;
+		
+		if (_nrThreads <= 1)
+		{
+				ClauseArena arena;
+				for (const ClauseTask& task : tasks)
+				{
+						arena.clear();
+						arena.setFirstAuxVar(_firstAuxVar);
+						task.write(arena);
+						emitClauses(arena);
+						if (!task.message.empty())
+						{
+								std::cout << task.message << std::endl;
+						}
+				}
+				return;
+		}
+		
+		// the workers run at most maxPending tasks ahead of the
+		// task whose clauses are written next
+		const int maxPending = 4 * _nrThreads;
+		std::vector<ClauseArena> arenas(nrTasks);
+		BoolVector done(nrTasks, false);
+		int nextTask = 0;
+		int nextWritten = 0;
+		std::mutex mutex;
+		std::condition_variable cv;
+		
+		auto worker = [&]()
+		{
+				while (true)
+				{
+						int idx;
+						{
+								std::unique_lock<std::mutex> lock(mutex);
+								cv.wait(lock, [&]() { return nextTask == nrTasks || nextTask < nextWritten + maxPending; });
+								if (nextTask == nrTasks)
+								{
+										break;
+								}
+								idx = nextTask++;
+						}
+						
+						arenas[idx].setFirstAuxVar(_firstAuxVar);
+						tasks[idx].write(arenas[idx]);
+						
+						{
+								std::lock_guard<std::mutex> lock(mutex);
+								done[idx] = true;
+						}
+						cv.notify_all();
+				}
+		};
+		
+		std::vector<std::thread> threads;
+		for (int i = 0; i < _nrThreads; ++i)
+		{
+				threads.push_back(std::thread(worker));
+		}
+		
+		for (int idx = 0; idx < nrTasks; ++idx)
+		{
+				{
+						std::unique_lock<std::mutex> lock(mutex);
+						cv.wait(lock, [&]() { return done[idx]; });
+				}
+				
+				emitClauses(arenas[idx]);
+				arenas[idx] = ClauseArena();
+				if (!tasks[idx].message.empty())
+				{
+						std::cout << tasks[idx].message << std::endl;
+				}
+				
+				{
+						std::lock_guard<std::mutex> lock(mutex);
+						nextWritten = idx + 1;
+				}
+				cv.notify_all();
+		}
+		
+		for (std::thread& thread : threads)
+		{
+				thread.join();
+		}
+}
+
+void Dimacs::emitClauses(ClauseArena& arena)
+{
+		arena.renumberAuxVars(_numVar + 1);
+		_numVar += arena.getNrAuxVars();
+		_numClauses += arena.size();
+		
+		if (_keepClauses)
+		{
+				_arena.append(arena);
+		}
+		else if (_clauseOut == &_solFile)
+		{
+				// a sampler reading the stream gets every finished task
+				arena.write(_solFile);
+				_solFile.flush();
+		}
+		else if (_clauseOut != nullptr)
+		{
+				arena.write(*_clauseOut);
+		}
+}
+
+void Dimacs::reserveClauses()
+{
+		if (_keepClauses)
+		{
+				// the one-hot and contact constraints have about nrHosts
+				// clauses per vertex variable, mostly with two or three literals
+				size_t nrClauses = size_t(_numVar) * _T.getNrHost();
+				_arena.reserve(nrClauses, 3 * nrClauses);
+		}
+}
+
+void Dimacs::initLists()
+{
+		const Digraph& G = tree();
+		const int nrInfectedHosts = _T.getNrHost();
+		
+		_nodes.clear();
+		for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+		{
+				_nodes.push_back(vi);
+				_feasibleLabels[vi] = getFeasibleLables(vi);
+		}
+		
+		_arcs.clear();
+		for (ArcIt eij(G); eij != lemon::INVALID; ++eij)
+		{
+				_arcs.push_back(eij);
+		}
+		const int nrArcs = _arcs.size();
+		
+		_byTargetTime = IntVector(nrArcs);
+		_bySourceTime = IntVector(nrArcs);
+		for (int p = 0; p < nrArcs; ++p)
+		{
+				_byTargetTime[p] = p;
+				_bySourceTime[p] = p;
+		}
+		std::sort(_byTargetTime.begin(), _byTargetTime.end(), [&](int p, int q)
+							{
+									return time(G.target(_arcs[p])) < time(G.target(_arcs[q]));
+							});
+		std::sort(_bySourceTime.begin(), _bySourceTime.end(), [&](int p, int q)
+							{
+									return time(G.source(_arcs[p])) < time(G.source(_arcs[q]));
+							});
+		
+		_targetTimes = DoubleVector(nrArcs);
+		_sourceTimes = DoubleVector(nrArcs);
+		for (int p = 0; p < nrArcs; ++p)
+		{
+				_targetTimes[p] = time(G.target(_arcs[_byTargetTime[p]]));
+				_sourceTimes[p] = time(G.source(_arcs[_bySourceTime[p]]));
+		}
+		
+		_contactTargets = IntMatrix(nrInfectedHosts);
+		_contactSources = IntMatrix(nrInfectedHosts);
+		for (int s = 0; s < nrInfectedHosts; ++s)
+		{
+				for (int t = 0; t < nrInfectedHosts; ++t)
+				{
+						if (s != t && _contact[s][t])
+						{
+								_contactTargets[s].push_back(t);
+								_contactSources[t].push_back(s);
+						}
+				}
+		}
+}
+
+void Dimacs::initVariables()
+{
+    if (!_solFile.good())
+    {
+        std::cerr << "error: failed opening solution file" << std::endl;
+    }
+    if (!_embedVarList && !_varFile.good())
+    {
+        std::cerr << "error: failed opening solution file" << std::endl;
+    }
+    
+    const Digraph& G = tree();
+		const Digraph& C = contactMap();
+    const int nrInfectedHosts = _T.getNrHost();
+    
+		_contact = BoolMatrix(nrInfectedHosts);
+		for (int s = 0; s < nrInfectedHosts; ++s)
+		{
+				_contact[s] = BoolVector(nrInfectedHosts, false);
+		}
+		
+		for (ArcIt eij(C); eij != lemon::INVALID; ++eij)
+		{
+				int sourceIndex = contactIndex(C.source(eij));
+				int targetIndex = contactIndex(C.target(eij));
+				
+				_contact[sourceIndex][targetIndex] = true;
+		}
+		
+    // init vertex variables, marking the candidate labels first
+    for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+    {
+        _Rv[vi] = IntVector(nrInfectedHosts, 0);
+				
+				if (vi != root() || _rootLabel == -1)
+				{
+						for (int s = 0; s < nrInfectedHosts; ++s)
+						{
+								if (time(vi) >= entTime(s) && time(vi) <= remTime(s))
+								{
+										_Rv[vi][s] = 1;
+								}
+						}
+				}
+				else if (vi == root())
+				{
+						_Rv[vi][_rootLabel] = 1;
+				}
+    }
+		
+		if (_pruneLabels)
+		{
+				pruneLabels();
+		}
+    
+    int rank = 1;
+    
+    for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+    {
+				for (int s = 0; s < nrInfectedHosts; ++s)
+				{
+						if (_Rv[vi][s] > 0)
+						{
+								_Rv[vi][s] = rank;
+								++rank;
+						}
+				}
+    }
+		_numVertexVar = rank - 1;
+		
+		_Rst = IntMatrix(nrInfectedHosts);
+		for (int s = 0; s < nrInfectedHosts; ++s)
+		{
+				_Rst[s] = IntVector(nrInfectedHosts);
+				for (int t = 0; t < nrInfectedHosts; ++t)
+				{
+						if (_contact[s][t])
+						{
+								_Rst[s][t] = rank;
+								++rank;
+						}
+				}
+		}
+		
+    _numVar = rank - 1;
+}
+
+bool Dimacs::isFeasibleTransition(Node vi, int p, Node vj, int q, int rootHost) const
+{
+		if (p == q)
+		{
+				return true;
+		}
+		
+		if (!_contact[p][q] || q == rootHost)
+		{
+				return false;
+		}
+		
+		// within the infection window of q, vj can only be labeled q if vi is
+		if (_T.infectionWindowExists(q)
+				&& time(vi) > _T.getInfectionWindow(q) && time(vj) <= _T.getRemTime(q))
+		{
+				return false;
+		}
+		
+		return true;
+}
+
+void Dimacs::pruneLabels()
+{
+		const Digraph& G = tree();
+		const int nrInfectedHosts = _T.getNrHost();
+		const NodeVector preOrder = _T.getPreOrder();
+		
+		int nrLabels = 0;
+		for (Node vi : preOrder)
+		{
+				if (lemon::countOutArcs(G, vi) == 0)
+				{
+						// leaf labels are fixed
+						int lhost = label(vi);
+						for (int s = 0; s < nrInfectedHosts; ++s)
+						{
+								nrLabels += _Rv[vi][s];
+								_Rv[vi][s] = _Rv[vi][s] > 0 && s == lhost ? 1 : 0;
+						}
+				}
+				else
+				{
+						for (int s = 0; s < nrInfectedHosts; ++s)
+						{
+								nrLabels += _Rv[vi][s];
+						}
+				}
+		}
+		
+		// a host that is the only feasible label of the root can not be infected
+		int rootHost = -1;
+		for (int s = 0; s < nrInfectedHosts; ++s)
+		{
+				if (_Rv[root()][s] > 0)
+				{
+						rootHost = rootHost == -1 ? s : -2;
+				}
+		}
+		
+		// bottom-up: vi can be labeled s if every child has a compatible label
+		for (auto it = preOrder.rbegin(); it != preOrder.rend(); ++it)
+		{
+				Node vi = *it;
+				
+				for (OutArcIt eij(G, vi); eij != lemon::INVALID; ++eij)
+				{
+						Node vj = G.target(eij);
+						
+						for (int p = 0; p < nrInfectedHosts; ++p)
+						{
+								if (_Rv[vi][p] == 0)
+								{
+										continue;
+								}
+								
+								bool supported = false;
+								for (int q = 0; q < nrInfectedHosts && !supported; ++q)
+								{
+										supported = _Rv[vj][q] > 0 && isFeasibleTransition(vi, p, vj, q, rootHost);
+								}
+								
+								if (!supported)
+								{
+										_Rv[vi][p] = 0;
+								}
+						}
+				}
+		}
+		
+		// top-down: vj can be labeled q if its parent has a compatible label
+		int nrPruned = nrLabels;
+		for (Node vi : preOrder)
+		{
+				for (OutArcIt eij(G, vi); eij != lemon::INVALID; ++eij)
+				{
+						Node vj = G.target(eij);
+						
+						for (int q = 0; q < nrInfectedHosts; ++q)
+						{
+								if (_Rv[vj][q] == 0)
+								{
+										continue;
+								}
+								
+								bool supported = false;
+								for (int p = 0; p < nrInfectedHosts && !supported; ++p)
+								{
+										supported = _Rv[vi][p] > 0 && isFeasibleTransition(vi, p, vj, q, rootHost);
+								}
+								
+								if (!supported)
+								{
+										_Rv[vj][q] = 0;
+								}
+						}
+				}
+				
+				for (int s = 0; s < nrInfectedHosts; ++s)
+				{
+						nrPruned -= _Rv[vi][s];
+				}
+		}
+		
+		std::cout << "arc consistency removed " << nrPruned << " of " << nrLabels << " vertex labels" << std::endl;
+}
+
+bool Dimacs::simplifyClauses()
+{
+		const int nrVars = _numVar;
+		const uint64_t nrClauses = _numClauses;
+		
+		CnfSimplifier simplifier(_arena, _numVar, _numVertexVar);
+		if (!simplifier.simplify())
+		{
+				std::cerr << "unit propagation derives a conflict : no solution!" << std::endl;
+				return false;
+		}
+		
+		_varValue = IntVector(_numVar + 1);
+		_newIndex = IntVector(_numVar + 1);
+		for (int var = 1; var <= _numVar; ++var)
+		{
+				_varValue[var] = simplifier.getValue(var);
+				_newIndex[var] = simplifier.getNewIndex(var);
+		}
+		
+		_arena.clear();
+		_arena.append(simplifier.getClauses());
+		_numVar = simplifier.getNrVars();
+		_numClauses = _arena.size();
+		
+		std::cout << "preprocessing reduced " << nrVars << " variables and " << nrClauses << " clauses to "
+							<< _numVar << " variables and " << _numClauses << " clauses" << std::endl;
+		
+		// the removed labels fixed to true scale every weighted count
+		if (_supportFormat == SUPPORT_PWMC)
+		{
+				double fixedWeight = 1;
+				for (NodeIt vi(tree()); vi != lemon::INVALID; ++vi)
+				{
+						for (int s = 0; s < static_cast<int>(_labelWeight[vi].size()); ++s)
+						{
+								if (_Rv[vi][s] > 0 && _varValue[_Rv[vi][s]] > 0)
+								{
+										fixedWeight *= _labelWeight[vi][s];
+								}
+						}
+				}
+				std::cout << "labels fixed by preprocessing have weight " << fixedWeight << std::endl;
+		}
+		
+		return true;
+}
+
+bool Dimacs::countExactly()
+{
+		const int nrInfectedHosts = _T.getNrHost();
+		
+		// the vertex labels are decided top-down, so that the components
+		// follow the subtrees of the phylogeny
+		IntVector order;
+		for (Node vi : _T.getPreOrder())
+		{
+				for (int s = 0; s < nrInfectedHosts; ++s)
+				{
+						if (_Rv[vi][s] > 0 && getOutputIndex(_Rv[vi][s]) > 0)
+						{
+								order.push_back(getOutputIndex(_Rv[vi][s]));
+						}
+				}
+		}
+		
+		const size_t maxCacheSize = 1 << 22;
+		DecisionCounter counter(_arena, _numVar, order, maxCacheSize);
+		
+		uint64_t nrSolutions = 0;
+		if (!counter.count(nrSolutions))
+		{
+				std::cerr << "exact counting exceeds " << maxCacheSize << " cached components or 64 bits" << std::endl;
+				return false;
+		}
+		
+		std::cout << "number of solutions: " << nrSolutions << " (" << counter.getCacheSize() << " cached components)" << std::endl;
+		
+		if (_nrSamples == 0 || nrSolutions == 0)
+		{
+				return true;
+		}
+		
+		// the samples have the format of the UniGen solutions
+		const std::string sampleFilename = _solFilename + ".samples";
+		std::ofstream sampleFile(sampleFilename.c_str());
+		if (!sampleFile.good())
+		{
+				std::cerr << "error: failed opening '" << sampleFilename << "' for writing" << std::endl;
+				return false;
+		}
+		
+		std::mt19937 rng(_seed);
+		IntVector solution;
+		for (int i = 0; i < _nrSamples; ++i)
+		{
+				counter.sample(rng, solution);
+				for (int lit : solution)
+				{
+						sampleFile << lit << " ";
+				}
+				sampleFile << "0" << std::endl;
+		}
+		sampleFile.close();
+		
+		std::cout << _nrSamples << " samples written to '" << sampleFilename << "'" << std::endl;
+		
+		return true;
+}
+
+void Dimacs::writeVariableList()
+{
+    const Digraph& G = tree();
+    const int nrInfectedHosts = _T.getNrHost();
+    
+		// an embedded variable list is written as comment lines of the formula
+		std::ostream& varFile = _embedVarList ? static_cast<std::ostream&>(_solFile) : _varFile;
+		const std::string prefix = _embedVarList ? "c var " : "";
+		
+    int rank = 1;
+    
+    for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+    {
+        for (int s = 0; s < nrInfectedHosts; ++s)
+        {
+            if (_Rv[vi][s] > 0 && getOutputIndex(_Rv[vi][s]) > 0)
+            {
+                varFile << prefix << getOutputIndex(_Rv[vi][s]) << " " << _T.getName(vi) << " " << _T.getContactName(s) << " (v,s)"<< std::endl;
+                ++rank;
+            }
+        }
+    }
+		
+		// labels fixed by preprocessing have index 0
+		if (!_newIndex.empty())
+		{
+				for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+				{
+						for (int s = 0; s < nrInfectedHosts; ++s)
+						{
+								if (_Rv[vi][s] > 0 && _varValue[_Rv[vi][s]] > 0)
+								{
+										varFile << prefix << 0 << " " << _T.getName(vi) << " " << _T.getContactName(s) << " (v,s)"<< std::endl;
+								}
+						}
+				}
+		}
+    
+		for (int s = 0; s < nrInfectedHosts; ++s)
+		{
+				for (int t = 0; t < nrInfectedHosts; ++t)
+				{
+						if (_Rst[s][t] > 0 && getOutputIndex(_Rst[s][t]) > 0)
+						{
+								varFile << prefix << getOutputIndex(_Rst[s][t]) << " " << _T.getContactName(s) << " " << _T.getContactName(t) << " (s,t)" << std::endl;
+								++rank;
+						}
+				}
+		}
+    
+		if (!_embedVarList)
+		{
+				_varFile.close();
+		}
+}
+
+void Dimacs::writeIndependentSupport()
+{
+    const Digraph& G = tree();
+    const int nrInfectedHosts = _T.getNrHost();
+    
+    IntVector vars;
+    
+    for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+    {
+        for (int s = 0; s < nrInfectedHosts; ++s)
+        {
+            if (_Rv[vi][s] > 0 && getOutputIndex(_Rv[vi][s]) > 0)
+            {
+                vars.push_back(getOutputIndex(_Rv[vi][s]));
+            }
+        }
+    }
+    
+    writeIndependentSupport(_solFile, vars);
+}
+
+void Dimacs::writeIndependentSupport(std::ostream& out, const IntVector& vars)
+{
+		if (_supportFormat != SUPPORT_UNIGEN)
+		{
+				out << "c t " << (_supportFormat == SUPPORT_PMC ? "pmc" : "pwmc") << std::endl;
+				
+				out << "c p show ";
+				for (int var : vars)
+				{
+						out << var << " ";
+				}
+				out << "0" << std::endl;
+				
+				if (_supportFormat == SUPPORT_PWMC)
+				{
+						// the weight of a label is the weight of its positive literal
+						DoubleVector weight(_numVar + 1, 1);
+						for (NodeIt vi(tree()); vi != lemon::INVALID; ++vi)
+						{
+								for (int s = 0; s < static_cast<int>(_labelWeight[vi].size()); ++s)
+								{
+										if (_Rv[vi][s] > 0 && getOutputIndex(_Rv[vi][s]) > 0)
+										{
+												weight[getOutputIndex(_Rv[vi][s])] = _labelWeight[vi][s];
+										}
+								}
+						}
+						
+						for (int var : vars)
+						{
+								out << "c p weight " << var << " " << weight[var] << " 0" << std::endl;
+								out << "c p weight " << -var << " 1 0" << std::endl;
+						}
+				}
+				
+				return;
+		}
+		
+    int rank = 1;
+    
+    out << "c ind ";
+    
+    for (int var : vars)
+    {
+        out << var << " ";
+        ++rank;
+        
+        if ((rank - 1)%10 == 0)
+        {
+            out << "0" << std::endl;
+            out << "c ind ";
+        }
+    }
+    
+    out << " 0" << std::endl;
+}
+
+bool Dimacs::readLabelWeights(std::istream& in)
+{
+		const int nrInfectedHosts = _T.getNrHost();
+		
+		while (in.good())
+		{
+				std::string line;
+				getline(in, line);
+				
+				if (line.empty())
+						break;
+				
+				StringVector s;
+				boost::split(s, line, boost::is_any_of("\t "));
+				
+				if (s.size() != 3)
+				{
+						std::cerr << "Error: line '" << line << "' incorrent number of columns" << std::endl;
+						return false;
+				}
+				
+				Node u = _T.getNodeByLabel(s[0]);
+				Node hostNode = _T.getContactNode(s[1]);
+				if (u == lemon::INVALID || hostNode == lemon::INVALID)
+				{
+						std::cerr << "Error: line '" << line << "' node or host not found" << std::endl;
+						return false;
+				}
+				
+				if (_labelWeight[u].empty())
+				{
+						_labelWeight[u] = DoubleVector(nrInfectedHosts, 1);
+				}
+				_labelWeight[u][_T.getContactIndex(hostNode)] = std::stod(s[2]);
+		}
+		
+		return true;
+}
+
+bool Dimacs::writeBinaryVariableMap()
+{
+		if (_varMapFilename.empty())
+		{
+				return true;
+		}
+		
+		const Digraph& G = tree();
+		const int nrInfectedHosts = _T.getNrHost();
+		
+		std::vector<VarMap::Entry> vars;
+		std::vector<VarMap::Entry> fixed;
+		for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+		{
+				for (int s = 0; s < nrInfectedHosts; ++s)
+				{
+						if (_Rv[vi][s] == 0)
+						{
+								continue;
+						}
+						
+						int var = getOutputIndex(_Rv[vi][s]);
+						if (var > 0)
+						{
+								if (static_cast<int>(vars.size()) < var)
+								{
+										vars.resize(var);
+								}
+								vars[var - 1] = {index(vi), s};
+						}
+						else if (_varValue[_Rv[vi][s]] > 0)
+						{
+								fixed.push_back({index(vi), s});
+						}
+				}
+		}
+		
+		StringVector nodeNames(lemon::countNodes(G));
+		for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+		{
+				nodeNames[index(vi)] = name(vi);
+		}
+		
+		StringVector hostNames(nrInfectedHosts);
+		for (int s = 0; s < nrInfectedHosts; ++s)
+		{
+				hostNames[s] = _T.getContactName(s);
+		}
+		
+		return VarMap::write(_varMapFilename, vars, fixed, nodeNames, hostNames);
+}
+
+void Dimacs::writeVariableOrder()
+{
+		if (_orderFilename.empty())
+		{
+				return;
+		}
+		
+		std::ofstream orderFile(_orderFilename.c_str());
+		if (!orderFile.good())
+		{
+				std::cerr << "error: failed opening '" << _orderFilename << "' for writing" << std::endl;
+				return;
+		}
+		
+		// the labels of the children precede those of their parent
+		for (Node vi : _T.getPostOrder())
+		{
+				for (int s = 0; s < _T.getNrHost(); ++s)
 				{
-						for (int s = 0; s < nrInfectedHosts; ++s)
+						if (_Rv[vi][s] > 0 && getOutputIndex(_Rv[vi][s]) > 0)
 						{
-								if (time(vi) >= entTime(s) && time(vi) <= remTime(s))
-								{
-										_Rv[vi][s] = rank;
-										++rank;
-								}
+								orderFile << getOutputIndex(_Rv[vi][s]) << std::endl;
 						}
 				}
-				else if (vi == root())
-				{
-						_Rv[vi][_rootLabel] = rank;
-						++rank;
-				}
-    }
+		}
+		
+		orderFile.close();
+}
 
-		_contact = BoolMatrix(nrInfectedHosts);
-		for (int s = 0; s < nrInfectedHosts; ++s)
+bool Dimacs::writeComponents()
+{
+		const int nrClauses = _arena.size();
+		
+		// the independent support is formed by the first variables
+		int nrIndependentVars = 0;
+		for (int var = 1; var <= _numVertexVar; ++var)
 		{
-				_contact[s] = BoolVector(nrInfectedHosts, false);
+				if (getOutputIndex(var) > 0)
+				{
+						++nrIndependentVars;
+				}
 		}
 		
-		for (ArcIt eij(C); eij != lemon::INVALID; ++eij)
+		// union-find over the variables of every clause
+		IntVector parent(_numVar + 1);
+		for (int var = 0; var <= _numVar; ++var)
 		{
-				int sourceIndex = contactIndex(C.source(eij));
-				int targetIndex = contactIndex(C.target(eij));
-				
-				_contact[sourceIndex][targetIndex] = true;
+				parent[var] = var;
 		}
 		
-		_Rst = IntMatrix(nrInfectedHosts);
-		for (int s = 0; s < nrInfectedHosts; ++s)
+		auto find = [&parent](int var)
 		{
-				_Rst[s] = IntVector(nrInfectedHosts);
-				for (int t = 0; t < nrInfectedHosts; ++t)
+				while (parent[var] != var)
 				{
-						if (_contact[s][t])
+						parent[var] = parent[parent[var]];
+						var = parent[var];
+				}
+				return var;
+		};
+		
+		BoolVector used(_numVar + 1, false);
+		for (int c = 0; c < nrClauses; ++c)
+		{
+				int first = abs(*_arena.begin(c));
+				used[first] = true;
+				for (const int* lit = _arena.begin(c) + 1; lit != _arena.end(c); ++lit)
+				{
+						used[abs(*lit)] = true;
+						int a = find(first);
+						int b = find(abs(*lit));
+						if (a != b)
 						{
-								_Rst[s][t] = rank;
-								++rank;
+								parent[std::max(a, b)] = std::min(a, b);
 						}
 				}
 		}
 		
-    _numVar = rank - 1;
-}
-
-void Dimacs::writeVariableList()
-{
-    const Digraph& G = tree();
-    const int nrInfectedHosts = _T.getNrHost();
-    
-    int rank = 1;
-    
-    for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
-    {
-        for (int s = 0; s < nrInfectedHosts; ++s)
-        {
-            if (_Rv[vi][s] > 0)
-            {
-                _varFile << _Rv[vi][s] << " " << _T.getName(vi) << " " << _T.getContactName(s) << " (v,s)"<< std::endl;
-                ++rank;
-            }
-        }
-    }
-    
-		for (int s = 0; s < nrInfectedHosts; ++s)
+		// independent variables without clauses form one component, components
+		// without independent variables are merged into the first component
+		int freeRoot = -1;
+		for (int var = 1; var <= nrIndependentVars; ++var)
 		{
-				for (int t = 0; t < nrInfectedHosts; ++t)
+				if (!used[var])
 				{
-						if (_Rst[s][t] > 0)
+						if (freeRoot == -1)
 						{
-								_varFile << _Rst[s][t] << " " << _T.getContactName(s) << " " << _T.getContactName(t) << " (s,t)" << std::endl;
-								++rank;
+								freeRoot = var;
 						}
+						parent[var] = freeRoot;
 				}
 		}
-    
-    _varFile.close();
-}
-
-void Dimacs::writeIndependentSupport()
-{
-    const Digraph& G = tree();
-    const int nrInfectedHosts = _T.getNrHost();
-    
-    int rank = 1;
-    
-    _solFile << "c ind ";
-    
-    for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
-    {
-        for (int s = 0; s < nrInfectedHosts; ++s)
-        {
-            if (_Rv[vi][s] > 0)
-            {
-                _solFile << getVarIndex(vi, s) << " ";
-                ++rank;
-                
-                if ((rank - 1)%10 == 0)
-                {
-                    _solFile << "0" << std::endl;
-                    _solFile << "c ind ";
-                }
-            }
-        }
-    }
-    
-    _solFile << " 0" << std::endl;
+		
+		IntVector componentIndex(_numVar + 1, -1);
+		int nrComponents = 0;
+		for (int var = 1; var <= nrIndependentVars; ++var)
+		{
+				int root = find(var);
+				if (componentIndex[root] == -1)
+				{
+						componentIndex[root] = nrComponents++;
+				}
+		}
+		
+		if (nrComponents == 0)
+		{
+				componentIndex[0] = nrComponents++;
+		}
+		
+		std::vector<IntVector> independentVars(nrComponents);
+		for (int var = 1; var <= nrIndependentVars; ++var)
+		{
+				independentVars[componentIndex[find(var)]].push_back(var);
+		}
+		
+		std::vector<ClauseArena> clauses(nrComponents);
+		for (int c = 0; c < nrClauses; ++c)
+		{
+				int idx = componentIndex[find(abs(*_arena.begin(c)))];
+				clauses[std::max(idx, 0)].add(_arena.begin(c), _arena.end(c));
+		}
+		
+		// every component keeps the numbering of the whole formula,
+		// so that samples of all components use the same variable list
+		for (int k = 0; k < nrComponents; ++k)
+		{
+				std::string filename = _solFilename + "." + std::to_string(k + 1);
+				std::ofstream out(filename.c_str());
+				if (!out.good())
+				{
+						std::cerr << "error: failed opening '" << filename << "' for writing" << std::endl;
+						return false;
+				}
+				
+				writeIndependentSupport(out, independentVars[k]);
+				out << "p cnf " << _numVar << " " << clauses[k].size() << std::endl;
+				clauses[k].write(out);
+				out.close();
+				
+				_solFile << "c component " << k + 1 << " " << filename << " "
+								 << independentVars[k].size() << " " << clauses[k].size() << std::endl;
+		}
+		
+		std::cout << "formula split into " << nrComponents << " components" << std::endl;
+		
+		return true;
 }
 
-void Dimacs::writeVertexTimeConstraints()
+void Dimacs::writeVertexTimeConstraints(ClauseArena& arena, int first, int last)
 {
     const Digraph& G = tree();
     const int nrInfectedHosts = _T.getNrHost();
 		
-		for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+		for (int i = first; i < last; ++i)
 		{
+				Node vi = _nodes[i];
+				
 				if (lemon::countOutArcs(G, vi) == 0)
 				{
 						int lhost = label(vi);
@@ -282,13 +1449,11 @@ void Dimacs::writeVertexTimeConstraints()
 						{
 								if (lhost == s)
 								{
-                    _clauses.push_back(IntVector({getVarIndex(vi, s)}));
-//                    _solFile << getVarIndex(vi, s) << " 0" << std::endl;
+                    arena.add({getVarIndex(vi, s)});
 								}
 								else if (_Rv[vi][s] > 0)
 								{
-                    _clauses.push_back(IntVector({-getVarIndex(vi, s)}));
-//                    _solFile << -getVarIndex(vi, s) << " 0" << std::endl;
+                    arena.add({-getVarIndex(vi, s)});
 								}
 						}
 				}
@@ -304,43 +1469,35 @@ void Dimacs::writeVertexTimeConstraints()
 								}
 						}
 				
-						writeOneHotConstraints(vi, feasibleLabels);
+						writeOneHotConstraints(arena, vi, feasibleLabels);
 				}
 		}
 }
 
-void Dimacs::writeOneHotConstraints(Node u, IntVector feasibleLabels)
+void Dimacs::writeOneHotConstraints(ClauseArena& arena, Node u, IntVector feasibleLabels)
 {
 		int nfeasible = feasibleLabels.size();
 		assert(nfeasible > 0);
 		
+		IntVector clause;
 		for (int i = 0; i < nfeasible; ++i)
 		{
-				for (int j = 0; j < i; ++j)
-				{
-            _clauses.push_back(IntVector({-getVarIndex(u, feasibleLabels[i]), -getVarIndex(u, feasibleLabels[j])}));
-//            _solFile << -getVarIndex(u, feasibleLabels[i]) << " " << -getVarIndex(u, feasibleLabels[j]) << " 0" << std::endl;
-				}
+				clause.push_back(getVarIndex(u, feasibleLabels[i]));
 		}
 		
-  
-    _clauses.push_back(IntVector({getVarIndex(u, feasibleLabels[0])}));
-//    _solFile << getVarIndex(u, feasibleLabels[0]);
-		for (int i = 1; i < nfeasible; ++i)
-		{
-        _clauses.back().push_back(getVarIndex(u, feasibleLabels[i]));
-//        _solFile << " " << getVarIndex(u, feasibleLabels[i]);
-		}
-//    _solFile << " 0" << std::endl;
+		writeAtMostOneConstraints(arena, clause);
+		arena.add(clause);
 }
 
-void Dimacs::writeVertexContactConstraints()
+void Dimacs::writeVertexContactConstraints(ClauseArena& arena, int first, int last)
 {
 		const Digraph& G = tree();
 		int nrInfectedHosts = _T.getNrHost();
 		
-		for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+		for (int i = first; i < last; ++i)
 		{
+				Node vi = _nodes[i];
+				
 				for (int s = 0; s < nrInfectedHosts; ++s)
 				{
 						if (_Rv[vi][s] > 0)
@@ -355,8 +1512,7 @@ void Dimacs::writeVertexContactConstraints()
 														
 														if (_Rv[vj][t] > 0)
 														{
-                                _clauses.push_back(IntVector({-getVarIndex(vi, s), -getVarIndex(vj, t)}));
-//                                _solFile << -getVarIndex(vi, s) << " " << -getVarIndex(vj, t) << " 0" << std::endl;
+                                arena.add({-getVarIndex(vi, s), -getVarIndex(vj, t)});
 														}
 												}
 										}
@@ -368,8 +1524,7 @@ void Dimacs::writeVertexContactConstraints()
 														
 														if (_Rv[vj][t] > 0)
 														{
-                                _clauses.push_back(IntVector({-getVarIndex(vi, s), -getVarIndex(vj, t), getVarIndex(s, t)}));
-//                                _solFile << -getVarIndex(vi, s) << " " << -getVarIndex(vj, t) << " " << getVarIndex(s, t) << " 0" << std::endl;
+                                arena.add({-getVarIndex(vi, s), -getVarIndex(vj, t), getVarIndex(s, t)});
 														}
 												}
 										}
@@ -379,43 +1534,58 @@ void Dimacs::writeVertexContactConstraints()
 		}
 }
 
-void Dimacs::writeInfectionTimeConstraints()
+void Dimacs::writeInfectionTimeConstraints(ClauseArena& arena, int first, int last)
 {
 		const Digraph& G = tree();
-		int nrInfectedHosts = _T.getNrHost();
 		
-		for (ArcIt eij(G); eij != lemon::INVALID; ++eij)
+		for (int p = first; p < last; ++p)
+		{
+				Arc eij = _arcs[p];
+				double ti = time(G.source(eij));
+				
+				// every pair of disjoint arcs is visited once, from the arc
+				// that starts after the other one ends
+				int nrEndingBefore = std::lower_bound(_targetTimes.begin(), _targetTimes.end(), ti) - _targetTimes.begin();
+				for (int r = 0; r < nrEndingBefore; ++r)
+				{
+						writeTransmissionPairConstraints(arena, eij, _arcs[_byTargetTime[r]]);
+				}
+		}
+}
+
+void Dimacs::writeStrongBottleneckCosntraints(ClauseArena& arena, int first, int last)
+{
+		const Digraph& G = tree();
+		const int nrArcs = _arcs.size();
+		
+		// the infection time constraints already forbid a repeated transmission
+		// on disjoint arcs, so only the overlapping pairs are visited here: the
+		// arcs ranked after eij by source time that start before eij ends
+		for (int p = first; p < last; ++p)
 		{
+				Arc eij = _arcs[_bySourceTime[p]];
 				Node vi = G.source(eij);
 				Node vj = G.target(eij);
+				double tj = time(vj);
 				
-				for (ArcIt ekl(G); ekl != lemon::INVALID; ++ekl)
+				for (int r = p + 1; r < nrArcs && _sourceTimes[r] <= tj; ++r)
 				{
+						Arc ekl = _arcs[_bySourceTime[r]];
 						Node vk = G.source(ekl);
 						Node vl = G.target(ekl);
 						
-						if (arc_index(eij) < arc_index(ekl))
+						for (int t : _feasibleLabels[vj])
 						{
-								double ti = time(vi);
-								double tj = time(vj);
-								double tk = time(vk);
-								double tl = time(vl);
+								if (t == _rootLabel || _Rv[vl][t] == 0)
+								{
+										continue;
+								}
 								
-								if ((ti > tl) || (tj < tk))
+								for (int s : _contactSources[t])
 								{
-										for (int s = 0; s < nrInfectedHosts; ++s)
+										if (_Rv[vi][s] > 0 && _Rv[vk][s] > 0)
 										{
-												for (int t = 0; t < nrInfectedHosts; ++t)
-												{
-														if (s != t && _contact[s][t])
-														{
-																if (_Rv[vi][s] > 0 && _Rv[vj][t] >0 && _Rv[vk][s] > 0 && _Rv[vl][t])
-																{
-                                    _clauses.push_back(IntVector({-getVarIndex(vi, s), -getVarIndex(vj, t), -getVarIndex(vk, s), -getVarIndex(vl, t)}));
-//                                    _solFile << -getVarIndex(vi, s) << " " << -getVarIndex(vj, t) << " " << -getVarIndex(vk, s) << " " << -getVarIndex(vl, t) << " 0" << std::endl;
-																}
-														}
-												}
+												arena.add({-getVarIndex(vi, s), -getVarIndex(vj, t), -getVarIndex(vk, s), -getVarIndex(vl, t)});
 										}
 								}
 						}
@@ -423,61 +1593,45 @@ void Dimacs::writeInfectionTimeConstraints()
 		}
 }
 
-void Dimacs::writeStrongBottleneckCosntraints()
+void Dimacs::writeTransmissionPairConstraints(ClauseArena& arena, Arc eij, Arc ekl)
 {
 		const Digraph& G = tree();
-		int nrInfectedHosts = _T.getNrHost();
+		Node vi = G.source(eij);
+		Node vj = G.target(eij);
+		Node vk = G.source(ekl);
+		Node vl = G.target(ekl);
 		
-		for (ArcIt eij(G); eij != lemon::INVALID; ++eij)
+		for (int s : _feasibleLabels[vi])
 		{
-				Node vi = G.source(eij);
-				Node vj = G.target(eij);
+				if (_Rv[vk][s] == 0)
+				{
+						continue;
+				}
 				
-				for (ArcIt ekl(G); ekl != lemon::INVALID; ++ekl)
+				for (int t : _contactTargets[s])
 				{
-						Node vk = G.source(ekl);
-						Node vl = G.target(ekl);
-						
-						if (arc_index(eij) < arc_index(ekl))
+						if (_Rv[vj][t] > 0 && _Rv[vl][t] > 0)
 						{
-								for (int t = 0; t < nrInfectedHosts; ++t)
-								{
-										if (t != _rootLabel)
-										{
-												for (int s = 0; s < nrInfectedHosts; ++s)
-												{
-														if (s != t && _contact[s][t])
-														{
-																if (_Rv[vi][s] > 0 && _Rv[vj][t] && _Rv[vk][s] > 0 && _Rv[vl][t])
-																{
-                                    _clauses.push_back(IntVector({-getVarIndex(vi, s), -getVarIndex(vj, t), -getVarIndex(vk, s), -getVarIndex(vl, t)}));
-//                                    _solFile << -getVarIndex(vi, s) << " " << -getVarIndex(vj, t) << " " << -getVarIndex(vk, s) << " " << -getVarIndex(vl, t) << " 0" << std::endl;
-																}
-														}
-												}
-										}
-								}
+								arena.add({-getVarIndex(vi, s), -getVarIndex(vj, t), -getVarIndex(vk, s), -getVarIndex(vl, t)});
 						}
 				}
 		}
 }
 
-void Dimacs::writeRootedDirectInfectionConstraints(int rootLabel)
+void Dimacs::writeRootedDirectInfectionConstraints(ClauseArena& arena, int rootLabel)
 {
 		int nrInfectedHosts = _T.getNrHost();
 		Node root = _T.root();
 		
 		// fix the root label
-    _clauses.push_back(IntVector({getVarIndex(root, rootLabel)}));
-//    _solFile << getVarIndex(root, rootLabel) << " 0" << std::endl;
+    arena.add({getVarIndex(root, rootLabel)});
   
 		// no one can infect the root label
 		for (int s = 0; s < nrInfectedHosts; ++s)
 		{
 				if (s != _rootLabel && _contact[s][_rootLabel])
 				{
-            _clauses.push_back(IntVector({-getVarIndex(s, _rootLabel)}));
-//            _solFile << -getVarIndex(s, _rootLabel) << " 0" << std::endl;
+            arena.add({-getVarIndex(s, _rootLabel)});
 				}
 		}
 		
@@ -487,30 +1641,22 @@ void Dimacs::writeRootedDirectInfectionConstraints(int rootLabel)
 				if (t != rootLabel)
 				{
 
-						IntVector feasibleSources;
+						IntVector sourceVars;
 						
 						for (int s = 0; s < nrInfectedHosts; ++s)
 						{
 								if (s != t && _contact[s][t])
 								{
-										feasibleSources.push_back(s);
+										sourceVars.push_back(getVarIndex(s, t));
 								}
 						}
 						
-						int nfeasible = feasibleSources.size();
-						for (int i = 0; i < nfeasible; ++i)
-						{
-								for (int j = 0; j < i; ++j)
-								{
-                    _clauses.push_back(IntVector({-getVarIndex(feasibleSources[i], t), -getVarIndex(feasibleSources[j], t)}));
-//                    _solFile << -getVarIndex(feasibleSources[i], t) << " " << -getVarIndex(feasibleSources[j], t) << " 0" << std::endl;
-								}
-						}
+						writeAtMostOneConstraints(arena, sourceVars);
 				}
 		}
 }
 
-void Dimacs::writeInfectionWindowConstraints()
+void Dimacs::writeInfectionWindowConstraints(ClauseArena& arena)
 {
 		const Digraph& G = tree();
 		int nrInfectedHosts = _T.getNrHost();
@@ -540,40 +1686,44 @@ void Dimacs::writeInfectionWindowConstraints()
 										}
 										*/
 										
-                    _clauses.push_back(IntVector({-getVarIndex(vj, s), getVarIndex(vi, s)}));
-//                    _solFile << -getVarIndex(vj, s) << " " << getVarIndex(vi, s) << " 0" << std::endl;
+										// labels pruned to false have no variable: vj can not be
+										// labeled s if vi can not, and the clause holds if vj can not
+										if (_Rv[vj][s] == 0)
+										{
+												continue;
+										}
+										
+										if (_Rv[vi][s] == 0)
+										{
+												arena.add({-getVarIndex(vj, s)});
+										}
+										else
+										{
+												arena.add({-getVarIndex(vj, s), getVarIndex(vi, s)});
+										}
 								}
 						}
 				}
 		}
 }
 
-void Dimacs::writeOneHotConstraints(int t, IntVector feasibleSources)
+void Dimacs::writeOneHotConstraints(ClauseArena& arena, int t, IntVector feasibleSources)
 {
 		int nfeasible = feasibleSources.size();
 		assert(nfeasible > 0);
 		
+		IntVector clause;
 		for (int i = 0; i < nfeasible; ++i)
 		{
-				for (int j = 0; j < i; ++j)
-				{
-            _clauses.push_back(IntVector({-getVarIndex(feasibleSources[i], t), -getVarIndex(feasibleSources[j], t)}));
-//            _solFile << -getVarIndex(feasibleSources[i], t) << " " << -getVarIndex(feasibleSources[j], t) << " 0" << std::endl;
-				}
+				clause.push_back(getVarIndex(feasibleSources[i], t));
 		}
 		
-		_clauses.push_back(IntVector({feasibleSources[0], t}));
-//    _solFile << getVarIndex(feasibleSources[0], t);
-		for (int i = 1; i < nfeasible; ++i)
-		{
-        _clauses.back().push_back(getVarIndex(feasibleSources[i], t));
-//        _solFile << " " << getVarIndex(feasibleSources[i], t);
-		}
-//    _solFile << " 0" << std::endl;
+		writeAtMostOneConstraints(arena, clause);
+		arena.add(clause);
 }
 
 
-void Dimacs::writeOneHotConstraints(Node u, BoolVector feasbileLabels)
+void Dimacs::writeOneHotConstraints(ClauseArena& arena, Node u, BoolVector feasbileLabels)
 {
     const int nrInfectedHosts = _T.getNrHost();
     assert(feasbileLabels.size() == nrInfectedHosts);
@@ -590,26 +1740,192 @@ void Dimacs::writeOneHotConstraints(Node u, BoolVector feasbileLabels)
     
     int nfeasible = feasiblePaths.size();
     
+    IntVector clause;
     for (int i = 0; i < nfeasible; ++i)
     {
-        for (int j = 0; j < i; ++j)
-        {
-            _clauses.push_back(IntVector({-getVarIndex(u, feasiblePaths[i]), -getVarIndex(u, feasiblePaths[j])}));
-//            _solFile << -getVarIndex(u, feasiblePaths[i]) << " " << -getVarIndex(u, feasiblePaths[j]) << " 0" << std::endl;
-        }
+        clause.push_back(getVarIndex(u, feasiblePaths[i]));
     }
     
-    _clauses.push_back(IntVector({getVarIndex(u, feasiblePaths[0])}));
-//    _solFile << getVarIndex(u, feasiblePaths[0]);
-    for (int i = 1; i < nfeasible; ++i)
-    {
-        _clauses.back().push_back(getVarIndex(u, feasiblePaths[i]));
-//        _solFile << " " << getVarIndex(u, feasiblePaths[i]);
-    }
-//    _solFile << " 0" << std::endl;
+    writeAtMostOneConstraints(arena, clause);
+    arena.add(clause);
+}
+
+void Dimacs::writeAtMostOneConstraints(ClauseArena& arena, const IntVector& literals)
+{
+		assert(_amoThreshold >= 4);
+		if (literals.size() < _amoThreshold)
+		{
+				writePairwiseAtMostOne(arena, literals);
+				return;
+		}
+		
+		switch (_amoEncoding)
+		{
+				case AMO_SEQUENTIAL:
+						writeSequentialAtMostOne(arena, literals);
+						break;
+				case AMO_COMMANDER:
+						writeCommanderAtMostOne(arena, literals);
+						break;
+				case AMO_PRODUCT:
+						writeProductAtMostOne(arena, literals);
+						break;
+				default:
+						writePairwiseAtMostOne(arena, literals);
+						break;
+		}
+}
+
+void Dimacs::writePairwiseAtMostOne(ClauseArena& arena, const IntVector& literals)
+{
+		int n = literals.size();
+		
+		for (int i = 0; i < n; ++i)
+		{
+				for (int j = 0; j < i; ++j)
+				{
+						arena.add({-literals[i], -literals[j]});
+				}
+		}
+}
+
+void Dimacs::writeSequentialAtMostOne(ClauseArena& arena, const IntVector& literals)
+{
+		int n = literals.size();
+		assert(n > 1);
+		
+		// the counter variable c[i] is true if one of literals 0 to i is true
+		int prev = arena.newVar();
+		arena.add({-literals[0], prev});
+		
+		for (int i = 1; i < n - 1; ++i)
+		{
+				int curr = arena.newVar();
+				arena.add({-literals[i], curr});
+				arena.add({-prev, curr});
+				arena.add({-literals[i], -prev});
+				prev = curr;
+		}
+		
+		arena.add({-literals[n - 1], -prev});
+}
+
+void Dimacs::writeCommanderAtMostOne(ClauseArena& arena, const IntVector& literals)
+{
+		int n = literals.size();
+		
+		// the commander variable of a group is true if one of its literals is true,
+		// at most one literal per group and at most one commander is true
+		IntVector commanders;
+		for (int first = 0; first < n; first += 3)
+		{
+				IntVector group(literals.begin() + first, literals.begin() + std::min(first + 3, n));
+				writePairwiseAtMostOne(arena, group);
+				
+				int c = arena.newVar();
+				for (int lit : group)
+				{
+						arena.add({-lit, c});
+				}
+				commanders.push_back(c);
+		}
+		
+		writeAtMostOneConstraints(arena, commanders);
+}
+
+void Dimacs::writeProductAtMostOne(ClauseArena& arena, const IntVector& literals)
+{
+		int n = literals.size();
+		int nrCols = std::ceil(std::sqrt(n));
+		int nrRows = (n + nrCols - 1) / nrCols;
+		
+		// literal i is in row i / nrCols and column i % nrCols of a grid,
+		// at most one row and at most one column are selected
+		IntVector rows, cols;
+		for (int r = 0; r < nrRows; ++r)
+		{
+				rows.push_back(arena.newVar());
+		}
+		for (int c = 0; c < nrCols; ++c)
+		{
+				cols.push_back(arena.newVar());
+		}
+		
+		for (int i = 0; i < n; ++i)
+		{
+				arena.add({-literals[i], rows[i / nrCols]});
+				arena.add({-literals[i], cols[i % nrCols]});
+		}
+		
+		writeAtMostOneConstraints(arena, rows);
+		writeAtMostOneConstraints(arena, cols);
+}
+
+void Dimacs::writeSymmetryBreakingConstraints(ClauseArena& arena)
+{
+		const int nrInfectedHosts = _T.getNrHost();
+		const int nrUnsampledHosts = _T.getUnHosts();
+		const int nrSampledHosts = nrInfectedHosts - nrUnsampledHosts;
+		
+		if (nrUnsampledHosts < 2)
+		{
+				return;
+		}
+		
+		// the auxiliary variable p[j] of a node is true if unsampled host j labels
+		// the node or one of its predecessors in pre-order. Unsampled host j + 1
+		// may only label a node if unsampled host j labels one of its predecessors.
+		// The auxiliary variables are numbered after all other variables and
+		// are not part of the independent support.
+		IntVector prev(nrUnsampledHosts - 1, 0);
+		
+		for (Node vi : _T.getPreOrder())
+		{
+				for (int j = 0; j < nrUnsampledHosts - 1; ++j)
+				{
+						int s = nrSampledHosts + j;
+						
+						if (_Rv[vi][s + 1] > 0)
+						{
+								if (prev[j] > 0)
+								{
+										arena.add({-getVarIndex(vi, s + 1), prev[j]});
+								}
+								else
+								{
+										arena.add({-getVarIndex(vi, s + 1)});
+								}
+						}
+				}
+				
+				for (int j = 0; j < nrUnsampledHosts - 1; ++j)
+				{
+						int s = nrSampledHosts + j;
+						
+						if (_Rv[vi][s] == 0)
+						{
+								continue;
+						}
+						
+						// p <-> prev[j] or x(vi, s)
+						int p = arena.newVar();
+						arena.add({-getVarIndex(vi, s), p});
+						if (prev[j] > 0)
+						{
+								arena.add({-prev[j], p});
+								arena.add({-p, getVarIndex(vi, s), prev[j]});
+						}
+						else
+						{
+								arena.add({-p, getVarIndex(vi, s)});
+						}
+						
+						prev[j] = p;
+				}
+		}
 }
 
-void Dimacs::writeUnRootedDirectInfectionConstraint()
+void Dimacs::writeUnRootedDirectInfectionConstraint(ClauseArena& arena)
 {
 		int nrInfectedHosts = _T.getNrHost();
 		Node root = _T.root();
@@ -629,22 +1945,19 @@ void Dimacs::writeUnRootedDirectInfectionConstraint()
 
 				int nfeasible = feasibleSources.size();
 
+				IntVector sourceVars;
 				for (int i = 0; i < nfeasible; ++i)
 				{
-						for (int j = 0; j < i; ++j)
-						{
-                _clauses.push_back(IntVector({-getVarIndex(feasibleSources[i], t), -getVarIndex(feasibleSources[j], t)}));
-//                _solFile << -getVarIndex(feasibleSources[i], t) << " " << -getVarIndex(feasibleSources[j], t) << " 0" << std::endl;
-						}
+						sourceVars.push_back(getVarIndex(feasibleSources[i], t));
 				}
+				writeAtMostOneConstraints(arena, sourceVars);
 				
 				// root node can not get infected by anyone
 				for (int i = 0; i < nfeasible; ++i)
 				{
 						if (_Rv[root][t] > 0 && _contact[feasibleSources[i]][t])
             {
-                _clauses.push_back(IntVector({-getVarIndex(root, t), -getVarIndex(feasibleSources[i], t)}));
-//                _solFile << -getVarIndex(root, t) << " " << -getVarIndex(feasibleSources[i], t) << " 0" << std::endl;
+                arena.add({-getVarIndex(root, t), -getVarIndex(feasibleSources[i], t)});
 						}
 				}
 		}
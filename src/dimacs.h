@@ -7,11 +7,38 @@
 
 #include "basetree.h"
 #include "utils.h"
+#include "clausearena.h"
 #include <fstream>
+#include <cstdio>
+#include <functional>
 
 class Dimacs
 {
 public:
+    /// encodings of at-most-one constraints
+    enum AtMostOneEncoding
+    {
+        AMO_PAIRWISE,
+        AMO_SEQUENTIAL,
+        AMO_COMMANDER,
+        AMO_PRODUCT
+    };
+    
+    /// formats of the independent support
+    enum SupportFormat
+    {
+        /// UniGen "c ind" lines
+        SUPPORT_UNIGEN,
+        /// projected model counting "c p show" line
+        SUPPORT_PMC,
+        /// projected weighted model counting "c p show" and "c p weight" lines
+        SUPPORT_PWMC
+    };
+    
+    /// constructor
+    ///
+    /// @param psol DIMACS output file, "-" for standard output
+    /// @param varlist Variable list output file, "-" to embed it in the DIMACS output
     Dimacs(const BaseTree& T,
            const int rootLabel,
            std::string psol,
@@ -19,6 +46,16 @@ public:
     
     /// initialize the exporter
     void initVariables();
+		
+		/// remove the vertex labels that are not used by any labeling satisfying
+		/// the constraints between a node and its children (arc consistency)
+		void pruneLabels();
+		
+		/// Return whether vi labeled p and its child vj labeled q satisfy the
+		/// contact map, infection window and root constraints
+		///
+		/// @param rootHost Host that labels the root in every labeling (-1 if none)
+		bool isFeasibleTransition(Node vi, int p, Node vj, int q, int rootHost) const;
     
     /// solver for dimacs
     virtual bool solveDimacs();
@@ -27,43 +64,244 @@ public:
     void writeVariableList();
 		
     /// vertex labeling time constraints
-    void writeVertexTimeConstraints();
+    /// (nodes first to last - 1 in node iteration order)
+    void writeVertexTimeConstraints(ClauseArena& arena, int first, int last);
 		
 		/// vertex labeling contact map constraints
-		void writeVertexContactConstraints();
+		/// (nodes first to last - 1 in node iteration order)
+		void writeVertexContactConstraints(ClauseArena& arena, int first, int last);
 		
 		/// rooted direct infection
-		void writeRootedDirectInfectionConstraints(int rootLabel);
+		void writeRootedDirectInfectionConstraints(ClauseArena& arena, int rootLabel);
 		
 		/// unrooted direct infection
-		void writeUnRootedDirectInfectionConstraint();
+		void writeUnRootedDirectInfectionConstraint(ClauseArena& arena);
 		
     /// write oneHot constraints (node)
-    void writeOneHotConstraints(Node u, BoolVector feasibleLabels);
+    void writeOneHotConstraints(ClauseArena& arena, Node u, BoolVector feasibleLabels);
 		
 		/// write oneHot constraints (node)
-		void writeOneHotConstraints(Node u, IntVector feasibleLabels);
+		void writeOneHotConstraints(ClauseArena& arena, Node u, IntVector feasibleLabels);
 
 		/// write oneHost constraints (contact)
-		void writeOneHotConstraints(int t, IntVector feasibleSources);
+		void writeOneHotConstraints(ClauseArena& arena, int t, IntVector feasibleSources);
+
+		/// write at-most-one constraints over literals, with auxiliary variables
+		/// of the arena when there are at least _amoThreshold literals
+		void writeAtMostOneConstraints(ClauseArena& arena, const IntVector& literals);
+
+		/// write pairwise at-most-one constraints
+		void writePairwiseAtMostOne(ClauseArena& arena, const IntVector& literals);
+
+		/// write sequential counter at-most-one constraints
+		void writeSequentialAtMostOne(ClauseArena& arena, const IntVector& literals);
+
+		/// write commander at-most-one constraints (groups of three)
+		void writeCommanderAtMostOne(ClauseArena& arena, const IntVector& literals);
+
+		/// write product at-most-one constraints
+		void writeProductAtMostOne(ClauseArena& arena, const IntVector& literals);
 		    
     /// write time constraints
-    void writeInfectionTimeConstraints();
+    /// (arcs first to last - 1 in arc iteration order)
+    void writeInfectionTimeConstraints(ClauseArena& arena, int first, int last);
 		
 		/// write infection window constraints
-		void writeInfectionWindowConstraints();
+		void writeInfectionWindowConstraints(ClauseArena& arena);
 		
 		/// write strong bottleneck constraints
-		void writeStrongBottleneckCosntraints();
+		/// (arcs first to last - 1 in order of source time)
+		void writeStrongBottleneckCosntraints(ClauseArena& arena, int first, int last);
+		
+		/// write the clauses forbidding that arcs eij and ekl are both
+		/// s->t transmissions
+		void writeTransmissionPairConstraints(ClauseArena& arena, Arc eij, Arc ekl);
+		
+		/// fill the node and arc orders and the feasible
+		/// label and contact lists used by the constraints
+		void initLists();
 		
     /// write independent support
     void writeIndependentSupport();
 		
+		/// write the independent support formed by vars
+		void writeIndependentSupport(std::ostream& out, const IntVector& vars);
+		
+		/// read the weights of vertex labels, lines "<node> <host> <weight>"
+		/// (labels that are not listed have weight 1)
+		bool readLabelWeights(std::istream& in);
+		
+		/// write the vertex label variables in post-order of the ptree
+		/// to the variable order file
+		void writeVariableOrder();
+		
+		/// write the vertex labels of the variables to the binary variable map
+		bool writeBinaryVariableMap();
+		
+		/// write every connected component of the variable interaction graph
+		/// of the kept clauses to <output_dimacs_file>.<k>, and the list of
+		/// components to the output file
+		bool writeComponents();
+		
+		/// a part of a constraint family, writing its clauses to an arena
+		struct ClauseTask
+		{
+				std::function<void(ClauseArena&)> write;
+				/// message printed once the clauses are written (may be empty)
+				std::string message;
+		};
+		
+		/// add the tasks writing the constraints of nrItems nodes or arcs in
+		/// chunks, the last one printing message
+		void addClauseTasks(std::vector<ClauseTask>& tasks, int nrItems,
+												std::function<void(ClauseArena&, int, int)> write,
+												const std::string& message);
+		
+		/// run the tasks on _nrThreads threads and write their clauses in
+		/// the order of the tasks, so that the output does not depend on the
+		/// number of threads
+		void runClauseTasks(const std::vector<ClauseTask>& tasks);
+		
+		/// number the auxiliary variables of a finished task and write its clauses
+		void emitClauses(ClauseArena& arena);
+		
+		/// reserve the arena of the clauses kept in memory
+		void reserveClauses();
+		
+		/// keep all clauses in memory instead of streaming them
+		void setKeepClauses()
+		{
+				_keepClauses = true;
+		}
+		
+		/// simplify the formula before writing it (keeps the clauses in memory)
+		void setPreprocessing()
+		{
+				_preprocess = true;
+				_keepClauses = true;
+		}
+		
+		/// write the independent components of the formula to separate files
+		/// (keeps the clauses in memory)
+		void setSplitComponents()
+		{
+				_splitComponents = true;
+				_keepClauses = true;
+		}
+		
+		/// count the labelings exactly and sample nrSamples of them uniformly
+		/// (keeps the clauses in memory)
+		void setExactCounting(int nrSamples, int seed)
+		{
+				_exactCount = true;
+				_nrSamples = nrSamples;
+				_seed = seed;
+				_keepClauses = true;
+		}
+		
+		/// count the projected models of the kept clauses with a component
+		/// caching search that branches on the vertex labels in pre-order,
+		/// and write the samples to <output_dimacs_file>.samples
+		bool countExactly();
+		
+		/// write only shard k (1 to nrShards) of the formula: a contiguous
+		/// slice of the arcs of the infection time and strong bottleneck
+		/// constraints, and for k = 1 all other constraints
+		void setShard(int shard, int nrShards)
+		{
+				_shard = shard;
+				_nrShards = nrShards;
+		}
+		
+		/// set the format of the independent support
+		void setSupportFormat(SupportFormat format)
+		{
+				_supportFormat = format;
+		}
+		
+		/// write a variable order hint to orderFilename
+		void setVariableOrderFile(const std::string& orderFilename)
+		{
+				_orderFilename = orderFilename;
+		}
+		
+		/// write a binary variable map to varMapFilename
+		void setBinaryVariableMapFile(const std::string& varMapFilename)
+		{
+				_varMapFilename = varMapFilename;
+		}
+		
+		/// read the clauses that do not depend on the contact map (vertex time
+		/// and infection window constraints) from a base formula in cacheDir,
+		/// or write it there first
+		void setBaseFormulaCache(const std::string& cacheDir)
+		{
+				_baseCacheDir = cacheDir;
+		}
+		
+		/// Return hash of the inputs of the base formula
+		uint64_t getBaseFormulaHash() const;
+		
+		/// find or write the base formula and renumber the contact variables
+		/// after its auxiliary variables
+		bool prepareBaseFormula();
+		
+		/// write the base formula to _baseFilename
+		bool writeBaseFormula(uint64_t hash);
+		
+		/// copy the clauses of the base formula to the output
+		void writeBaseClauses();
+		
+		/// keep the vertex labels that arc consistency shows infeasible
+		void setNoLabelPruning()
+		{
+				_pruneLabels = false;
+		}
+		
+		/// simplify the kept clauses by unit propagation and pure literal
+		/// elimination and renumber the variables
+		bool simplifyClauses();
+		
+		/// Return index of a variable in the written formula (0 if removed)
+		int getOutputIndex(int var) const
+		{
+				return _newIndex.empty() ? var : _newIndex[var];
+		}
+		
+		/// Return the clauses (only kept with setKeepClauses)
+		const ClauseArena& getClauses() const
+		{
+				return _arena;
+		}
+		
+		/// set the number of threads generating the clauses
+		void setNrThreads(int nrThreads)
+		{
+				_nrThreads = std::max(nrThreads, 1);
+		}
+		
+		/// write symmetry breaking constraints for interchangeable unsampled hosts
+		/// (unsampled hosts are used in order of first occurrence in pre-order)
+		void writeSymmetryBreakingConstraints(ClauseArena& arena);
+		
 		void setStrongBottleneck()
 		{
 				_bottleneck = true;
 		}
 		
+		void setSymmetryBreaking()
+		{
+				_symmetryBreaking = true;
+		}
+		
+		/// set the at-most-one encoding used for at least threshold (at least 4)
+		/// literals, smaller constraints are encoded pairwise
+		void setAtMostOneEncoding(AtMostOneEncoding encoding, int threshold)
+		{
+				_amoEncoding = encoding;
+				_amoThreshold = threshold;
+		}
+		
     /// get variable index
     int getVarIndex(Node u, int label)
     {
@@ -171,6 +409,8 @@ protected:
 		const int _rootLabel;
 		// bottleneck constraint
 		bool _bottleneck;
+		// symmetry breaking of unsampled hosts
+		bool _symmetryBreaking;
 		
     // vaiable rank in the list of
     // variables for SAT problem (vertices and edges)
@@ -178,9 +418,7 @@ protected:
 		IntMatrix _Rst;
 		BoolMatrix _contact;
   
-    // clauses
-    IntMatrix _clauses;
-		
+
 		// number of boolean variables
     int _numVar;
 		
@@ -188,4 +426,79 @@ protected:
     std::ofstream _solFile;
     // output variable file
     std::ofstream _varFile;
+		// output DIMACS file name ("-" for standard output)
+		std::string _solFilename;
+		// write the variable list as comment lines of the DIMACS file
+		bool _embedVarList;
+		// write the clauses to the DIMACS file while they are generated
+		bool _streamClauses;
+		// stream of the generated clauses (counted only if null)
+		std::ostream* _clauseOut;
+		// temporary clause file, the clauses are streamed to it
+		// and copied after the header once their number is known
+		std::string _clauseFilename;
+		std::ofstream _clauseFile;
+		// keep all clauses in memory
+		bool _keepClauses;
+		// simplify the formula before writing it
+		bool _preprocess;
+		// prune the vertex labels by arc consistency
+		bool _pruneLabels;
+		// write the independent components of the formula to separate files
+		bool _splitComponents;
+		// count the labelings exactly
+		bool _exactCount;
+		// number of uniform samples of the labelings
+		int _nrSamples;
+		// seed of the sampler
+		int _seed;
+		// shard of the formula that is written (1 to _nrShards)
+		int _shard;
+		int _nrShards;
+		// format of the independent support
+		SupportFormat _supportFormat;
+		// weight of every vertex label (empty if no weights are read)
+		DoubleVectorNodeMap _labelWeight;
+		// variable order file (empty if none)
+		std::string _orderFilename;
+		// binary variable map file (empty if none)
+		std::string _varMapFilename;
+		// base formula cache directory (empty if none)
+		std::string _baseCacheDir;
+		// base formula file
+		std::string _baseFilename;
+		// number of clauses of the base formula
+		uint64_t _baseNrClauses;
+		// kept clauses
+		ClauseArena _arena;
+		// number of clauses
+		uint64_t _numClauses;
+		// number of threads generating the clauses
+		int _nrThreads;
+		// index of the first auxiliary variable
+		int _firstAuxVar;
+		// at-most-one encoding
+		AtMostOneEncoding _amoEncoding;
+		// minimum number of literals for which _amoEncoding is used
+		int _amoThreshold;
+		// number of vertex variables, they are the first variables
+		int _numVertexVar;
+		// value of every variable after preprocessing (1 true, -1 false, 0 free)
+		IntVector _varValue;
+		// index of every variable in the preprocessed formula (0 if removed)
+		IntVector _newIndex;
+		
+		// nodes and arcs in iteration order
+		NodeVector _nodes;
+		ArcVector _arcs;
+		// arc positions sorted by the time of their target and of their source
+		IntVector _byTargetTime;
+		IntVector _bySourceTime;
+		DoubleVector _targetTimes;
+		DoubleVector _sourceTimes;
+		// feasible labels of every node
+		IntVectorNodeMap _feasibleLabels;
+		// contact targets and sources (other than itself) of every host
+		IntMatrix _contactTargets;
+		IntMatrix _contactSources;
 };
@@ -9,6 +9,7 @@
 #include "dimacs.h"
 #include "basetree.h"
 #include <fstream>
+#include <thread>
 #include <lemon/arg_parser.h>
 
 int main(int argc, char** argv)
@@ -24,6 +25,22 @@ int main(int argc, char** argv)
 		std::string contactmap_filename;
 		std::string infectionwindow_filename;
 		bool strongBottleneckFlag = false;
+		bool symmetryBreakingFlag = false;
+		int nrThreads = std::thread::hardware_concurrency();
+		std::string amoEncoding = "sequential";
+		int amoThreshold = 8;
+		bool preprocessFlag = false;
+		bool noPruningFlag = false;
+		bool componentsFlag = false;
+		bool exactCountFlag = false;
+		int nrSamples = 0;
+		int seed = 0;
+		std::string shardSpec;
+		std::string supportFormat = "unigen";
+		std::string weight_filename;
+		std::string order_filename;
+		std::string baseCacheDir;
+		std::string varmap_filename;
 		
     lemon::ArgParser ap(argc, argv);
     ap.refOption("r", "Root label (default: 0)", rootLabel);
@@ -31,6 +48,22 @@ int main(int argc, char** argv)
 		ap.refOption("c", "contact map file: (default: empty)", contactmap_filename);
 		ap.refOption("i", "infection window file: (default: empty)", infectionwindow_filename);
 		ap.refOption("s", "strong bottleneck flag: (default: false)", strongBottleneckFlag);
+		ap.refOption("y", "symmetry breaking of unsampled hosts flag: (default: false)", symmetryBreakingFlag);
+		ap.refOption("p", "simplify the formula by unit propagation and pure literal elimination (default: false)", preprocessFlag);
+		ap.refOption("d", "write the independent components to <output_dimacs_file>.<k> (default: false)", componentsFlag);
+		ap.refOption("n", "no arc consistency pruning of the vertex labels (default: false)", noPruningFlag);
+		ap.refOption("e", "count the labelings exactly (default: false)", exactCountFlag);
+		ap.refOption("l", "number of uniform samples written to <output_dimacs_file>.samples with -e (default: 0)", nrSamples);
+		ap.refOption("z", "random number generator seed of the samples (default: 0)", seed);
+		ap.refOption("f", "independent support format: unigen (c ind), pmc (c p show) or pwmc (c p show and c p weight) (default: unigen)", supportFormat);
+		ap.refOption("w", "vertex label weight file for -f pwmc, lines <node> <host> <weight> (default: empty)", weight_filename);
+		ap.refOption("o", "variable order file, the vertex labels in post-order of the ptree (default: empty)", order_filename);
+		ap.refOption("m", "binary variable map file, read by unigenparser in place of the varlist (default: empty)", varmap_filename);
+		ap.refOption("b", "base formula cache directory, only the contact map dependent clauses are generated, implies -n (default: empty)", baseCacheDir);
+		ap.refOption("x", "write only shard k/N of the formula, merged by dimacsmerge (default: 1/1)", shardSpec);
+		ap.refOption("j", "Number of threads (default: number of cores)", nrThreads);
+		ap.refOption("a", "at-most-one encoding: pairwise, sequential, commander or product (default: sequential)", amoEncoding);
+		ap.refOption("k", "minimum number of literals encoded with -a, at least 4, fewer are pairwise (default: 8)", amoThreshold);
     ap.other("<host>");
     ap.other("<ptree>");
     ap.other("<output_dimacs_file>");
@@ -43,11 +76,125 @@ int main(int argc, char** argv)
         std::cerr << "Error1: expected <host>/<transmission_tree> <ptree> <output_dimacs_file> <output_varlist_file>" << std::endl;
         return 1;
     }
+		
+		Dimacs::AtMostOneEncoding encoding;
+		if (amoEncoding == "pairwise")
+		{
+				encoding = Dimacs::AMO_PAIRWISE;
+		}
+		else if (amoEncoding == "sequential")
+		{
+				encoding = Dimacs::AMO_SEQUENTIAL;
+		}
+		else if (amoEncoding == "commander")
+		{
+				encoding = Dimacs::AMO_COMMANDER;
+		}
+		else if (amoEncoding == "product")
+		{
+				encoding = Dimacs::AMO_PRODUCT;
+		}
+		else
+		{
+				std::cerr << "Error6: unknown at-most-one encoding '" << amoEncoding << "'" << std::endl;
+				return 1;
+		}
+		
+		// the product encoding of 2 literals has 2 columns, it would recurse
+		// forever on the columns if such constraints were not pairwise
+		if (amoThreshold < 4)
+		{
+				std::cerr << "Error10: -k must be at least 4" << std::endl;
+				return 1;
+		}
+
+		Dimacs::SupportFormat format;
+		if (supportFormat == "unigen")
+		{
+				format = Dimacs::SUPPORT_UNIGEN;
+		}
+		else if (supportFormat == "pmc")
+		{
+				format = Dimacs::SUPPORT_PMC;
+		}
+		else if (supportFormat == "pwmc")
+		{
+				format = Dimacs::SUPPORT_PWMC;
+		}
+		else
+		{
+				std::cerr << "Error11: unknown independent support format '" << supportFormat << "'" << std::endl;
+				return 1;
+		}
+		
+		int shard = 1;
+		int nrShards = 1;
+		if (!shardSpec.empty())
+		{
+				StringVector s;
+				boost::split(s, shardSpec, boost::is_any_of("/"));
+				try
+				{
+						if (s.size() != 2)
+						{
+								throw boost::bad_lexical_cast();
+						}
+						shard = boost::lexical_cast<int>(s[0]);
+						nrShards = boost::lexical_cast<int>(s[1]);
+				}
+				catch (boost::bad_lexical_cast&)
+				{
+						shard = 0;
+				}
+				
+				if (shard < 1 || shard > nrShards)
+				{
+						std::cerr << "Error8: invalid shard '" << shardSpec << "', expected k/N with 1 <= k <= N" << std::endl;
+						return 1;
+				}
+				
+				if (nrShards > 1 && (preprocessFlag || componentsFlag || exactCountFlag))
+				{
+						std::cerr << "Error13: -x cannot be combined with -p, -d or -e" << std::endl;
+						return 1;
+				}
+		}
+		
+		if (!baseCacheDir.empty() && (preprocessFlag || componentsFlag || exactCountFlag || nrShards > 1))
+		{
+				std::cerr << "Error9: -b cannot be combined with -p, -d, -e or -x" << std::endl;
+				return 1;
+		}
+		
+		// arc consistency pruning depends on the contact map, so the base formula
+		// of pruned labels would differ between contact maps
+		if (!baseCacheDir.empty())
+		{
+				noPruningFlag = true;
+		}
 
     host_filename = ap.files()[0];
     ptree_filename = ap.files()[1];
     dimacs_filename = ap.files()[2];
     varlist_filename = ap.files()[3];
+		
+		if (dimacs_filename == "-")
+		{
+				if (componentsFlag)
+				{
+						std::cerr << "Error7: -d requires a DIMACS output file" << std::endl;
+						return 1;
+				}
+				
+				if (exactCountFlag && nrSamples > 0)
+				{
+						std::cerr << "Error12: -l requires a DIMACS output file" << std::endl;
+						return 1;
+				}
+				
+				// the formula is written to standard output, messages to standard error
+				std::cout.rdbuf(std::cerr.rdbuf());
+		}
 
     std::ifstream host_file(host_filename.c_str());
     if (!host_file.good())
@@ -122,7 +269,63 @@ int main(int argc, char** argv)
 				solver.setStrongBottleneck();
 		}
 		
-    solver.solveDimacs();
+		if (symmetryBreakingFlag)
+		{
+				solver.setSymmetryBreaking();
+		}
+		
+		solver.setNrThreads(nrThreads);
+		solver.setAtMostOneEncoding(encoding, amoThreshold);
+		
+		if (preprocessFlag)
+		{
+				solver.setPreprocessing();
+		}
+		
+		if (noPruningFlag)
+		{
+				solver.setNoLabelPruning();
+		}
+		
+		if (componentsFlag)
+		{
+				solver.setSplitComponents();
+		}
+		
+		if (exactCountFlag)
+		{
+				solver.setExactCounting(nrSamples, seed);
+		}
+		
+		solver.setShard(shard, nrShards);
+		solver.setSupportFormat(format);
+		solver.setVariableOrderFile(order_filename);
+		solver.setBinaryVariableMapFile(varmap_filename);
+		
+		if (!baseCacheDir.empty())
+		{
+				solver.setBaseFormulaCache(baseCacheDir);
+		}
+		
+		if (!weight_filename.empty())
+		{
+				std::ifstream weight_file(weight_filename.c_str());
+				if (!weight_file.good())
+				{
+						std::cerr << "Error 4: failed openning '" << weight_filename << "' for reading" << std::endl;
+						return 1;
+				}
+				
+				if (!solver.readLabelWeights(weight_file))
+				{
+						return 1;
+				}
+		}
+		
+    if (!solver.solveDimacs())
+    {
+        return 1;
+    }
     
     return 0;
 }
@@ -0,0 +1,188 @@
+/*
+ * dimacsmergemain.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: P. Sashittal
+ */
+
+#include "utils.h"
+#include <fstream>
+#include <lemon/arg_parser.h>
+
+/// header of a shard written by dimacs -x k/N
+struct ShardHeader
+{
+		std::string filename;
+		int shard;
+		int nrShards;
+		int nrSharedVars;
+		int nrVars;
+		uint64_t nrClauses;
+		/// comment lines other than the shard line
+		StringVector comments;
+};
+
+/// read the lines of a shard up to its "p cnf" line,
+/// a file without a shard line is shard 1 of 1
+bool readShardHeader(std::istream& in, ShardHeader& header)
+{
+		header.shard = 0;
+
+		std::string line;
+		while (getline(in, line))
+		{
+				StringVector s;
+				boost::split(s, line, boost::is_any_of(" \t"), boost::token_compress_on);
+
+				if (s.size() == 5 && s[0] == "c" && s[1] == "shard")
+				{
+						header.shard = boost::lexical_cast<int>(s[2]);
+						header.nrShards = boost::lexical_cast<int>(s[3]);
+						header.nrSharedVars = boost::lexical_cast<int>(s[4]);
+				}
+				else if (!s.empty() && s[0] == "c")
+				{
+						header.comments.push_back(line);
+				}
+				else if (s.size() == 4 && s[0] == "p" && s[1] == "cnf")
+				{
+						header.nrVars = boost::lexical_cast<int>(s[2]);
+						header.nrClauses = boost::lexical_cast<uint64_t>(s[3]);
+						
+						// dimacs writes no shard line for a single shard (-x 1/1)
+						if (header.shard == 0)
+						{
+								header.shard = 1;
+								header.nrShards = 1;
+								header.nrSharedVars = header.nrVars;
+						}
+						return true;
+				}
+		}
+
+		return false;
+}
+
+int main(int argc, char** argv)
+{
+		lemon::ArgParser ap(argc, argv);
+		ap.other("<shard_file>", "one file per shard written by dimacs -x k/N, in any order");
+		ap.other("<output_dimacs_file>", "\"-\" for standard output");
+		ap.parse();
+
+		if (ap.files().size() < 2)
+		{
+				std::cerr << "Error1: expected <shard_file> [<shard_file> ...] <output_dimacs_file>" << std::endl;
+				return 1;
+		}
+
+		StringVector shard_filenames(ap.files().begin(), ap.files().end() - 1);
+		std::string dimacs_filename = ap.files().back();
+
+		// the shards in order of their index
+		std::vector<ShardHeader> headers(shard_filenames.size());
+		for (const std::string& filename : shard_filenames)
+		{
+				std::ifstream in(filename.c_str());
+				if (!in.good())
+				{
+						std::cerr << "Error2: failed opening '" << filename << "' for reading" << std::endl;
+						return 1;
+				}
+
+				ShardHeader header;
+				header.filename = filename;
+				try
+				{
+						if (!readShardHeader(in, header))
+						{
+								throw boost::bad_lexical_cast();
+						}
+				}
+				catch (boost::bad_lexical_cast&)
+				{
+						std::cerr << "Error3: '" << filename << "' is not a shard written by dimacs -x" << std::endl;
+						return 1;
+				}
+
+				if (header.nrShards != static_cast<int>(headers.size()) || header.shard > header.nrShards)
+				{
+						std::cerr << "Error4: '" << filename << "' is shard " << header.shard << " of " << header.nrShards
+											<< ", but " << headers.size() << " shards are given" << std::endl;
+						return 1;
+				}
+
+				ShardHeader& slot = headers[header.shard - 1];
+				if (!slot.filename.empty())
+				{
+						std::cerr << "Error4: '" << slot.filename << "' and '" << filename << "' are both shard " << header.shard << std::endl;
+						return 1;
+				}
+				slot = header;
+		}
+
+		// the variables up to nrSharedVars are the same in every shard,
+		// the auxiliary variables of shard k follow those of shards 1 to k-1
+		const int nrSharedVars = headers.front().nrSharedVars;
+		IntVector offset(headers.size(), 0);
+		int nrVars = nrSharedVars;
+		uint64_t nrClauses = 0;
+		for (size_t k = 0; k < headers.size(); ++k)
+		{
+				if (headers[k].nrSharedVars != nrSharedVars)
+				{
+						std::cerr << "Error4: the shards have different variables" << std::endl;
+						return 1;
+				}
+
+				offset[k] = nrVars - nrSharedVars;
+				nrVars += headers[k].nrVars - nrSharedVars;
+				nrClauses += headers[k].nrClauses;
+		}
+
+		std::ofstream out(dimacs_filename == "-" ? "/dev/stdout" : dimacs_filename.c_str());
+		if (!out.good())
+		{
+				std::cerr << "Error2: failed opening '" << dimacs_filename << "' for writing" << std::endl;
+				return 1;
+		}
+
+		// the independent support and the embedded variable list of the first shard
+		for (const std::string& line : headers.front().comments)
+		{
+				out << line << std::endl;
+		}
+		out << "p cnf " << nrVars << " " << nrClauses << std::endl;
+
+		for (size_t k = 0; k < headers.size(); ++k)
+		{
+				std::ifstream in(headers[k].filename.c_str());
+				ShardHeader header;
+				readShardHeader(in, header);
+
+				if (offset[k] == 0)
+				{
+						if (headers[k].nrClauses > 0)
+						{
+								out << in.rdbuf();
+						}
+						continue;
+				}
+
+				int lit;
+				while (in >> lit)
+				{
+						if (abs(lit) > nrSharedVars)
+						{
+								lit += lit > 0 ? offset[k] : -offset[k];
+						}
+						out << lit << (lit == 0 ? '\n' : ' ');
+				}
+		}
+
+		out.close();
+
+		std::cerr << "merged " << headers.size() << " shards into " << nrVars << " variables and " << nrClauses << " clauses" << std::endl;
+
+		return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * mappedfile.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: P. Sashittal
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// This class maps a file read-only into memory
+class MappedFile
+{
+public:
+    /// Default constructor
+    MappedFile()
+        : _data(nullptr)
+        , _size(0)
+    {
+    }
+
+    /// Destructor
+    ~MappedFile()
+    {
+        close();
+    }
+
+    /// map a file, returns false if it cannot be opened or mapped
+    bool open(const std::string& filename)
+    {
+        close();
+
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd == -1)
+        {
+            return false;
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+        {
+            ::close(fd);
+            return false;
+        }
+
+        _size = fileStat.st_size;
+        if (_size > 0)
+        {
+            void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                ::close(fd);
+                _size = 0;
+                return false;
+            }
+            _data = static_cast<const char*>(data);
+        }
+
+        ::close(fd);
+        return true;
+    }
+
+    /// advise the kernel that the file is read once from start to end
+    void adviseSequential() const
+    {
+        if (_data != nullptr)
+        {
+            madvise(const_cast<char*>(_data), _size, MADV_SEQUENTIAL);
+        }
+    }
+
+    /// unmap the file
+    void close()
+    {
+        if (_data != nullptr)
+        {
+            munmap(const_cast<char*>(_data), _size);
+        }
+        _data = nullptr;
+        _size = 0;
+    }
+
+    /// Return start of the file (nullptr if it is empty)
+    const char* data() const
+    {
+        return _data;
+    }
+
+    /// Return size of the file
+    size_t size() const
+    {
+        return _size;
+    }
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// mapped file
+    const char* _data;
+    size_t _size;
+};
+
+#endif // MAPPEDFILE_H
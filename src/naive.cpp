@@ -7,25 +7,32 @@
 
 #include "naive.h"
 
-Naive::Naive(const BaseTree& T, const int rootLabel = -1)
+Naive::Naive(const BaseTree& T, const int rootLabel = -1, std::ostream& log)
     :  _T(T)
+    , _log(log)
     , _rootLabel(rootLabel)
     , _solMap(_T.tree())
     , _M(_T.tree())
     , _N(_T.tree())
     , _W(_T.tree())
     , _G(_T.tree())
+    , _rng(&g_rng)
+    , _numReducedSols(0)
+    , _deltaOutput(false)
+    , _quiet(false)
+    , _prevSolMap(_T.tree())
+    , _hasPrevSol(false)
 		//, _contactLookUp(_T.contactMap())
 {
     if (_rootLabel == -1)
     {
-        std::cout << "no root label prescribed" << std::endl;
+        _log << "no root label prescribed" << std::endl;
     }
     else
     {
-        std::cout << "value of the root label is " << _rootLabel + 1 << std::endl;
+        _log << "value of the root label is " << _rootLabel + 1 << std::endl;
     }
-    std::cout << "Solving Sankoff Labeling" << std::endl;
+    _log << "Solving Sankoff Labeling" << std::endl;
 }
 
 void Naive::init()
@@ -69,17 +76,17 @@ bool Naive::solveSankoff()
     
     if (_M[root][_solMap[root]] == std::numeric_limits<uint64_t>::max())
     {
-        std::cout << "no solution exists!" << std::endl;
+        _log << "no solution exists!" << std::endl;
         return false;
     }
     else
     {
-        std::cout << "Root Label is: " << _solMap[root] + 1 << std::endl;
-        std::cout << "Infection number solution is: " << _M[root][_solMap[root]] << std::endl;
+        _log << "Root Label is: " << _solMap[root] + 1 << std::endl;
+        _log << "Infection number solution is: " << _M[root][_solMap[root]] << std::endl;
         computeSol(root, _solMap[root]);
         
         int gamma = computeCoInf();
-        std::cout << "Coinfection number solution is: " << gamma << std::endl;
+        _log << "Coinfection number solution is: " << gamma << std::endl;
         
         return true;
     }
@@ -88,9 +95,42 @@ bool Naive::solveSankoff()
 uint64_t Naive::countSankoff()
 {
     Node root = _T.root();
-    int nrInfectedHosts = _T.getNrHost();
     runCount(root);
     
+    uint64_t numSols = countSankoffRoot();
+    
+    if (numSols == 0)
+    {
+        return 0;
+    }
+    
+    _numSols = numSols;
+    _log << "Number of Sankoff solutions is: " << _numSols << std::endl;
+    
+    computeWeight(root);
+    
+    /*
+    _log << "node\tstate\tweight" << std::endl;
+    for (NodeIt vi(_T.tree()); vi != lemon::INVALID; ++vi)
+    {
+        for (int s = 0; s < nrInfectedHosts; ++s)
+        {
+            if (_W[vi][s] > 0)
+            {
+                _log << name(vi) << "\t" << s + 1 << "\t" << _W[vi][s] << std::endl;
+            }
+        }
+    }
+    */
+    
+    return numSols;
+}
+
+uint64_t Naive::countSankoffRoot()
+{
+    Node root = _T.root();
+    int nrInfectedHosts = _T.getNrHost();
+    
     uint64_t numSols = 0;
     
     if (_rootLabel == -1)
@@ -99,16 +139,16 @@ uint64_t Naive::countSankoff()
         
         if (min_cost == std::numeric_limits<uint64_t>::max())
         {
-            std::cout << "no solutions exist!" << std::endl;
+            _log << "no solutions exist!" << std::endl;
             return 0;
         }
         
-        std::cout << "feasible roots are: ";
+        _log << "feasible roots are: ";
         for (int s = 0; s < nrInfectedHosts; ++s)
         {
             if (_M[root][s] == min_cost)
             {
-                std::cout << s + 1 << ", ";
+                _log << s + 1 << ", ";
                 numSols += _N[root][s];
             }
             else
@@ -116,21 +156,21 @@ uint64_t Naive::countSankoff()
                 _N[root][s] = 0;
             }
         }
-        std::cout << std::endl;
+        _log << std::endl;
         
-        std::cout << "Infection number solution is: " << min_cost << std::endl;
+        _log << "Infection number solution is: " << min_cost << std::endl;
     }
     else
     {
         if (_M[root][_rootLabel] == std::numeric_limits<uint64_t>::max())
         {
-            std::cout << "no solutions exist!" << std::endl;
+            _log << "no solutions exist!" << std::endl;
             return 0;
         }
         
         numSols = _N[root][_rootLabel];
         
-        std::cout << "Infection number solution is: " << _M[root][_rootLabel] << std::endl;
+        _log << "Infection number solution is: " << _M[root][_rootLabel] << std::endl;
         
         for (int s = 0; s < nrInfectedHosts; ++s)
         {
@@ -141,25 +181,6 @@ uint64_t Naive::countSankoff()
         }
     }
     
-    _numSols = numSols;
-    std::cout << "Number of Sankoff solutions is: " << _numSols << std::endl;
-    
-    computeWeight(root);
-    
-    /*
-    std::cout << "node\tstate\tweight" << std::endl;
-    for (NodeIt vi(_T.tree()); vi != lemon::INVALID; ++vi)
-    {
-        for (int s = 0; s < nrInfectedHosts; ++s)
-        {
-            if (_W[vi][s] > 0)
-            {
-                std::cout << name(vi) << "\t" << s + 1 << "\t" << _W[vi][s] << std::endl;
-            }
-        }
-    }
-    */
-    
     return numSols;
 }
 
@@ -205,7 +226,7 @@ uint64_t Naive::countContact()
 		}
 		
 		_numSols = numSols;
-		std::cout << "Number of contact-constrained solutions is: " << _numSols << std::endl;
+		_log << "Number of contact-constrained solutions is: " << _numSols << std::endl;
 		
 		return numSols;
 }
@@ -224,16 +245,16 @@ bool Naive::solveConsensus()
 				
         if (min_cost == std::numeric_limits<uint64_t>::max())
         {
-            std::cout << "no solutions exist!" << std::endl;
+            _log << "no solutions exist!" << std::endl;
             return false;
         }
         
-        std::cout << "feasible roots are: ";
+        _log << "feasible roots are: ";
         for (int s = 0; s < nrInfectedHosts; ++s)
         {
             if (_M[root][s] == min_cost)
             {
-                std::cout << s + 1 << ", ";
+                _log << s + 1 << ", ";
                 numSols += _N[root][s];
             }
             else
@@ -241,7 +262,7 @@ bool Naive::solveConsensus()
                 _N[root][s] = 0;
             }
         }
-        std::cout << std::endl;
+        _log << std::endl;
     }
     else
     {
@@ -249,7 +270,7 @@ bool Naive::solveConsensus()
         
         if (_M[root][_rootLabel] == std::numeric_limits<uint64_t>::max())
         {
-            std::cout << "no solutions exist!" << std::endl;
+            _log << "no solutions exist!" << std::endl;
             return false;
         }
         
@@ -263,7 +284,7 @@ bool Naive::solveConsensus()
     }
     
     _numSols = numSols;
-    std::cout << "Number of Sankoff solutions is: " << _numSols << std::endl;
+    _log << "Number of Sankoff solutions is: " << _numSols << std::endl;
     
     computeWeight(root);
     
@@ -284,7 +305,7 @@ bool Naive::solveConsensus()
     
     if (_M[root][_solMap[root]] == std::numeric_limits<uint64_t>::max())
     {
-        std::cout << "no solution exists!" << std::endl;
+        _log << "no solution exists!" << std::endl;
         return false;
     }
     else
@@ -293,29 +314,29 @@ bool Naive::solveConsensus()
         
         int gamma = computeCoInf();
         
-        std::cout << "Coinfection number consensus solution is: " << gamma << std::endl;
+        _log << "Coinfection number consensus solution is: " << gamma << std::endl;
         
 
-        std::cout << "node\tstate\tweight" << std::endl;
+        _log << "node\tstate\tweight" << std::endl;
         for (NodeIt vi(_T.tree()); vi != lemon::INVALID; ++vi)
         {
             for (int s = 0; s < nrInfectedHosts; ++s)
             {
                 if (_W[vi][s] > 0)
                 {
-                    std::cout << name(vi) << "\t\t" << s + 1 << "\t\t" << _W[vi][s] << std::endl;
+                    _log << name(vi) << "\t\t" << s + 1 << "\t\t" << _W[vi][s] << std::endl;
                 }
             }
         }
         
-        std::cout << "node\tstate\tpenalty" << std::endl;
+        _log << "node\tstate\tpenalty" << std::endl;
         for (NodeIt vi(_T.tree()); vi != lemon::INVALID; ++vi)
         {
             for (int s = 0; s < nrInfectedHosts; ++s)
             {
                 if (_W[vi][s] > 0)
                 {
-                    std::cout << name(vi) << "\t\t" << s + 1 << "\t\t" << _G[vi][s] << std::endl;
+                    _log << name(vi) << "\t\t" << s + 1 << "\t\t" << _G[vi][s] << std::endl;
                 }
             }
         }
@@ -405,6 +426,20 @@ void Naive::run(Node u)
 }
 
 void Naive::runCount(Node u)
+{
+    const Digraph& G = tree();
+    
+    for (Digraph::OutArcIt a(G, u); a != lemon::INVALID; ++a)
+    {
+        Node v = G.target(a);
+        
+        runCount(v);
+    }
+    
+    computeCount(u);
+}
+
+void Naive::computeCount(Node u)
 {
     const Digraph& G = tree();
     const int nrInfectedHosts = _T.getNrHost();
@@ -428,13 +463,6 @@ void Naive::runCount(Node u)
     }
     else
     {
-        for (Digraph::OutArcIt a(G, u); a != lemon::INVALID; ++a)
-        {
-            Node v = G.target(a);
-            
-            runCount(v);
-        }
-        
         // compute _M[u][s] and _N[u][s]
         for (int s = 0; s < nrInfectedHosts; ++s)
         {
@@ -475,11 +503,37 @@ void Naive::runCount(Node u)
 }
 
 void Naive::runContactCount(Node u)
+{
+		runContactCount(u, _N, lemon::INVALID, _T.getNrHost());
+}
+
+void Naive::runContactCount(Node u, UInt64VectorNodeMap& N, Arc excluded, int nrAllowedHosts)
+{
+		const Digraph& G = tree();
+		
+		for (Digraph::OutArcIt a(G,u); a != lemon::INVALID; ++a)
+		{
+				Node v = G.target(a);
+				
+				runContactCount(v, N, excluded, nrAllowedHosts);
+		}
+		
+		computeContactCount(u, N, excluded, nrAllowedHosts);
+}
+
+void Naive::computeContactCount(Node u)
+{
+		computeContactCount(u, _N, lemon::INVALID, _T.getNrHost());
+}
+
+void Naive::computeContactCount(Node u, UInt64VectorNodeMap& N, Arc excluded, int nrAllowedHosts)
 {
 		const Digraph& G = tree();
 		const Digraph& C = _T.contactMap();
 		const int nrInfectedHosts = _T.getNrHost();
 		
+		N[u].resize(nrInfectedHosts);
+		
 		if (lemon::countOutArcs(G, u) == 0)
 		{
 				// is leaf
@@ -487,54 +541,210 @@ void Naive::runContactCount(Node u)
 				{
 						if (s == _T.getHostLabel(u))
 						{
-								_N[u][s] = 1;
+								N[u][s] = 1;
 						}
 						else
 						{
-								_N[u][s] = 0;
+								N[u][s] = 0;
 						}
 				}
 		}
 		else
 		{
-				for (Digraph::OutArcIt a(G,u); a != lemon::INVALID; ++a)
-				{
-						Node v = G.target(a);
-						
-						runContactCount(v);
-				}
-				
-				// compute _N[u][s] for all s
+				// compute N[u][s] for all s
 				for (int s = 0; s < nrInfectedHosts; ++s)
 				{
-						if (_T.getEntTime(s) > _T.getTime(u) || _T.getRemTime(s) < _T.getTime(u))
+						if (s >= nrAllowedHosts || _T.getEntTime(s) > _T.getTime(u) || _T.getRemTime(s) < _T.getTime(u))
 						{
-								_N[u][s] = 0;
+								N[u][s] = 0;
 						}
 						else
 						{
-								_N[u][s] = 1;
+								N[u][s] = 1;
 								
 								for (Digraph::OutArcIt a(G,u); a != lemon::INVALID; ++a)
 								{
 										Node v = G.target(a);
-										uint64_t childPaths = _N[v][s];
+										uint64_t childPaths = N[v][s];
 										
 										Node sHost = _T.getContactNode(s);
 										for (Digraph::OutArcIt e(C, sHost); e != lemon::INVALID; ++e)
 										{
+												if (e == excluded)
+														continue;
+												
 												Node tHost = C.target(e);
 												
-												childPaths += _N[v][_T.getContactIndex(tHost)];
+												childPaths += N[v][_T.getContactIndex(tHost)];
 										}
 										
-										_N[u][s] *= childPaths;
+										N[u][s] *= childPaths;
 								}
 						}
 				}
 		}
 }
 
+uint64_t Naive::updateContactCount(Node leaf)
+{
+		// only the charts of the new leaf and its ancestors are affected
+		for (Node u = leaf; u != lemon::INVALID; u = _T.parent(u))
+		{
+				computeContactCount(u);
+		}
+		
+		_numSols = getContactRootCount(_N);
+		_log << "Number of contact-constrained solutions after grafting leaf " << name(leaf) << " is: " << _numSols << std::endl;
+		
+		return _numSols;
+}
+
+uint64_t Naive::updateSankoffCount(Node leaf)
+{
+		const int nrInfectedHosts = _T.getNrHost();
+		
+		// only the charts of the new leaf and its ancestors are affected
+		for (Node u = leaf; u != lemon::INVALID; u = _T.parent(u))
+		{
+				_M[u].resize(nrInfectedHosts);
+				_N[u].resize(nrInfectedHosts);
+				_W[u].resize(nrInfectedHosts);
+				_G[u].resize(nrInfectedHosts);
+				computeCount(u);
+		}
+		
+		_numSols = countSankoffRoot();
+		_log << "Number of Sankoff solutions after grafting leaf " << name(leaf) << " is: " << _numSols << std::endl;
+		
+		return _numSols;
+}
+
+uint64_t Naive::getContactRootCount(const UInt64VectorNodeMap& N) const
+{
+		Node root = _T.root();
+		const int nrInfectedHosts = _T.getNrHost();
+		
+		if (_rootLabel != -1)
+		{
+				return N[root][_rootLabel];
+		}
+		
+		uint64_t numSols = 0;
+		for (int s = 0; s < nrInfectedHosts; ++s)
+		{
+				numSols += N[root][s];
+		}
+		
+		return numSols;
+}
+
+void Naive::accumulateTransmissionStats(TransmissionStats& stats)
+{
+		const Digraph& G = tree();
+		const Digraph& C = _T.contactMap();
+		const int nrInfectedHosts = _T.getNrHost();
+		Node root = _T.root();
+		
+		uint64_t numSols = getContactRootCount(_N);
+		if (numSols == 0)
+		{
+				return;
+		}
+		
+		// P[v][s] : number of labelings of the subtree of v given that the parent of v is labeled s
+		UInt64VectorNodeMap P(G);
+		for (NodeIt v(G); v != lemon::INVALID; ++v)
+		{
+				P[v] = UInt64Vector(nrInfectedHosts, 0);
+				
+				if (v == root)
+						continue;
+				
+				for (int s = 0; s < nrInfectedHosts; ++s)
+				{
+						P[v][s] = _N[v][s];
+						
+						for (Digraph::OutArcIt e(C, _T.getContactNode(s)); e != lemon::INVALID; ++e)
+						{
+								P[v][s] += _N[v][_T.getContactIndex(C.target(e))];
+						}
+				}
+		}
+		
+		// O[v][s] : number of labelings of the rest of the tree given that v is labeled s
+		UInt64VectorNodeMap O(G);
+		O[root] = UInt64Vector(nrInfectedHosts, 0);
+		for (int s = 0; s < nrInfectedHosts; ++s)
+		{
+				if (_rootLabel == -1 || s == _rootLabel)
+				{
+						O[root][s] = 1;
+				}
+		}
+		
+		DoubleMatrix transmissions(nrInfectedHosts, DoubleVector(nrInfectedHosts, 0));
+		
+		// pre-order traversal
+		NodeList stack(1, root);
+		while (!stack.empty())
+		{
+				Node u = stack.back();
+				stack.pop_back();
+				
+				for (Digraph::OutArcIt a(G, u); a != lemon::INVALID; ++a)
+				{
+						Node v = G.target(a);
+						O[v] = UInt64Vector(nrInfectedHosts, 0);
+						stack.push_back(v);
+						
+						for (int s = 0; s < nrInfectedHosts; ++s)
+						{
+								if (O[u][s] == 0 || _N[u][s] == 0)
+										continue;
+								
+								// labelings of the siblings of v
+								uint64_t others = 1;
+								for (Digraph::OutArcIt b(G, u); b != lemon::INVALID; ++b)
+								{
+										if (b != a)
+										{
+												others *= P[G.target(b)][s];
+										}
+								}
+								
+								uint64_t outside = O[u][s] * others;
+								
+								O[v][s] += outside;
+								
+								for (Digraph::OutArcIt e(C, _T.getContactNode(s)); e != lemon::INVALID; ++e)
+								{
+										int t = _T.getContactIndex(C.target(e));
+										
+										O[v][t] += outside;
+										transmissions[s][t] += double(outside) * double(_N[v][t]);
+								}
+						}
+				}
+		}
+		
+		// labelings that use s->t are those that are lost when the contact arc is removed
+		DoubleMatrix usage(nrInfectedHosts, DoubleVector(nrInfectedHosts, 0));
+		UInt64VectorNodeMap N(G);
+		for (ArcIt est(C); est != lemon::INVALID; ++est)
+		{
+				int s = _T.getContactIndex(C.source(est));
+				int t = _T.getContactIndex(C.target(est));
+				
+				if (transmissions[s][t] == 0)
+						continue;
+				
+				runContactCount(root, N, est, nrInfectedHosts);
+				usage[s][t] = double(numSols - getContactRootCount(N));
+		}
+		
+		stats.add(double(numSols), transmissions, usage);
+}
+
 void Naive::runConsensus(Node u)
 {
     const Digraph& G = tree();
@@ -701,7 +911,7 @@ void Naive::getSample()
   const int nrInfectedHosts = _T.getNrHost();
   
   std::uniform_real_distribution<double> distribution(0.0,1.0);
-  double p = distribution(g_rng);
+  double p = distribution(*_rng);
   
   double cum = 0;
   for (int s = 0; s < nrInfectedHosts; ++s)
@@ -743,7 +953,7 @@ void Naive::getSample(Node u, int label)
             }
         }
         
-        double random_number = totalN*distribution(g_rng);
+        double random_number = totalN*distribution(*_rng);
         
         for (int i = 0; i < feasibleLabels.size(); ++i)
         {
@@ -763,7 +973,7 @@ void Naive::getContactSample()
   const int nrInfectedHosts = _T.getNrHost();
   
   std::uniform_real_distribution<double> distribution(0.0,1.0);
-  double p = distribution(g_rng);
+  double p = distribution(*_rng);
   
   double cum = 0;
   for (int s = 0; s < nrInfectedHosts; ++s)
@@ -779,6 +989,11 @@ void Naive::getContactSample()
 }
 
 void Naive::getContactSample(Node u, int s)
+{
+		getContactSample(u, s, _N);
+}
+
+void Naive::getContactSample(Node u, int s, const UInt64VectorNodeMap& N)
 {
 		const Digraph& G = tree();
 		const Digraph& C = _T.contactMap();
@@ -793,9 +1008,9 @@ void Naive::getContactSample(Node u, int s)
 				uint64_t totalN = 0;
 				UInt64IntPairVector feasibleLabels;
 
-				if (_N[v][s] > 0)
+				if (N[v][s] > 0)
 				{
-						totalN += _N[v][s];
+						totalN += N[v][s];
 						feasibleLabels.push_back(std::make_pair(totalN, s));
 				}
 				
@@ -804,14 +1019,14 @@ void Naive::getContactSample(Node u, int s)
 						Node tHost = C.target(e);
 						int t = _T.getContactIndex(tHost);
 						
-						if (_N[v][t] > 0)
+						if (N[v][t] > 0)
 						{
-								totalN += _N[v][t];
+								totalN += N[v][t];
 								feasibleLabels.push_back(std::make_pair(totalN, t));
 						}
 				}
 				
-				double random_number = totalN*distribution(g_rng);
+				double random_number = totalN*distribution(*_rng);
 				
 				for (int i = 0; i < feasibleLabels.size(); ++i)
 				{
@@ -822,7 +1037,174 @@ void Naive::getContactSample(Node u, int s)
 						}
 				}
 				
-				getContactSample(v, _solMap[v]);
+				getContactSample(v, _solMap[v], N);
+		}
+}
+
+uint64_t Naive::countContactReduced(std::ostream& psol)
+{
+		Node root = _T.root();
+		const int nrInfectedHosts = _T.getNrHost();
+		const int nrUnsampledHosts = _T.getUnHosts();
+		const int nrSampledHosts = nrInfectedHosts - nrUnsampledHosts;
+		
+		if (!_T.unsampledHostsInterchangeable())
+		{
+				std::cerr << "unsampled hosts are not interchangeable" << std::endl;
+				return 0;
+		}
+		
+		if (_rootLabel >= nrSampledHosts)
+		{
+				std::cerr << "root label can not be an unsampled host" << std::endl;
+				return 0;
+		}
+		
+		uint64_t numSols = countContactSolutions(psol);
+		if (numSols == 0)
+		{
+				return 0;
+		}
+		
+		// f[j] : number of solutions using only the first j unsampled hosts
+		UInt64Vector f(nrUnsampledHosts + 1);
+		_restrictedN.clear();
+		for (int j = 0; j < nrUnsampledHosts; ++j)
+		{
+				_restrictedN.push_back(std::unique_ptr<UInt64VectorNodeMap>(new UInt64VectorNodeMap(tree())));
+				runContactCount(root, *_restrictedN[j], lemon::INVALID, nrSampledHosts + j);
+				f[j] = getContactRootCount(*_restrictedN[j]);
+		}
+		f[nrUnsampledHosts] = numSols;
+		
+		// g[j] : number of solutions using exactly the first j unsampled hosts,
+		// by binomial inversion of f[j] = sum_i C(j,i) g[i]. The arithmetic wraps
+		// around modulo 2^64, which is exact as long as g[j] itself fits.
+		// Each orbit of the solutions using j unsampled hosts has j! elements.
+		_reducedCounts = UInt64Vector(nrUnsampledHosts + 1);
+		uint64_t numReducedSols = 0;
+		for (int j = 0; j <= nrUnsampledHosts; ++j)
+		{
+				uint64_t g = 0;
+				uint64_t binom = 1;
+				for (int i = 0; i <= j; ++i)
+				{
+						if ((j - i) % 2 == 0)
+						{
+								g += binom * f[i];
+						}
+						else
+						{
+								g -= binom * f[i];
+						}
+						binom = binom * (j - i) / (i + 1);
+				}
+				
+				for (int i = 2; i <= j; ++i)
+				{
+						g /= i;
+				}
+				
+				_reducedCounts[j] = g;
+				numReducedSols += g;
+		}
+		
+		_numReducedSols = numReducedSols;
+		_log << "Number of contact-constrained solutions up to permutation of unsampled hosts is: " << _numReducedSols << std::endl;
+		
+		return numReducedSols;
+}
+
+void Naive::getContactReducedSample()
+{
+		Node root = _T.root();
+		const int nrInfectedHosts = _T.getNrHost();
+		const int nrUnsampledHosts = _T.getUnHosts();
+		const int nrSampledHosts = nrInfectedHosts - nrUnsampledHosts;
+		
+		std::uniform_real_distribution<double> distribution(0.0,1.0);
+		
+		// pick the number of unsampled hosts in proportion to the number of orbits
+		double random_number = _numReducedSols*distribution(*_rng);
+		uint64_t cum = 0;
+		int j = nrUnsampledHosts;
+		for (int i = 0; i <= nrUnsampledHosts; ++i)
+		{
+				cum += _reducedCounts[i];
+				if (random_number < cum)
+				{
+						j = i;
+						break;
+				}
+		}
+		
+		const UInt64VectorNodeMap& N = j == nrUnsampledHosts ? _N : *_restrictedN[j];
+		
+		// sample uniformly from the solutions using the first j unsampled hosts
+		// until all of them are used; the solution is then uniform within its
+		// orbit and is replaced by the canonical representative
+		BoolVector used(nrUnsampledHosts);
+		int nrUsed = -1;
+		while (nrUsed != j)
+		{
+				if (_rootLabel != -1)
+				{
+						_solMap[root] = _rootLabel;
+				}
+				else
+				{
+						uint64_t numSols = getContactRootCount(N);
+						double p = numSols*distribution(*_rng);
+						
+						uint64_t rootCum = 0;
+						for (int s = 0; s < nrInfectedHosts; ++s)
+						{
+								rootCum += N[root][s];
+								if (p < rootCum)
+								{
+										_solMap[root] = s;
+										break;
+								}
+						}
+				}
+				
+				getContactSample(root, _solMap[root], N);
+				
+				std::fill(used.begin(), used.end(), false);
+				nrUsed = 0;
+				for (NodeIt vi(tree()); vi != lemon::INVALID; ++vi)
+				{
+						int s = _solMap[vi];
+						if (s >= nrSampledHosts && !used[s - nrSampledHosts])
+						{
+								used[s - nrSampledHosts] = true;
+								++nrUsed;
+						}
+				}
+		}
+		
+		canonizeUnsampledHosts(_solMap);
+}
+
+void Naive::canonizeUnsampledHosts(IntNodeMap& label) const
+{
+		const int nrInfectedHosts = _T.getNrHost();
+		const int nrSampledHosts = nrInfectedHosts - _T.getUnHosts();
+		
+		// relabel the unsampled hosts in the order of their first occurrence in pre-order
+		IntVector relabel(nrInfectedHosts, -1);
+		int next = nrSampledHosts;
+		for (Node u : _T.getPreOrder())
+		{
+				int s = label[u];
+				if (s >= nrSampledHosts)
+				{
+						if (relabel[s] == -1)
+						{
+								relabel[s] = next++;
+						}
+						label[u] = relabel[s];
+				}
 		}
 }
 
@@ -915,7 +1297,7 @@ bool Naive::enumerateSankoff(std::ostream& psol)
     // enumeration chart
     // chart[sol_id][(vector of label and nodeID)]
     
-    std::cout << "solId\troot\tCoInf" << std::endl;
+    _log << "solId\troot\tCoInf" << std::endl;
     
     if (_rootLabel == -1)
     {
@@ -944,7 +1326,7 @@ bool Naive::enumerateContact(std::ostream& psol)
 		Node root = _T.root();
 		const int nrInfectedHosts = _T.getNrHost();
 		
-		std::cout << "SolId\troot\tnInf\tCoInf" << std::endl;
+		_log << "SolId\troot\tnInf\tCoInf" << std::endl;
 		
 		if (_rootLabel)
 		{
@@ -987,10 +1369,13 @@ void Naive::writeSol(std::ostream& psol, const IntStringPairMatrix& sol)
         }
         
         int gamma = computeCoInf();
-        std::cout << i << "\t" << _solMap[_T.root()] + 1 << "\t" << gamma << std::endl;
-        psol << "# idx = " << i << " -- root = " << _solMap[_T.root()] + 1 << " -- gamma = " << gamma << std::endl;
+        if (!_quiet)
+        {
+            _log << i << "\t" << _solMap[_T.root()] + 1 << "\t" << gamma << '\n';
+        }
+        psol << "# idx = " << i << " -- root = " << _solMap[_T.root()] + 1 << " -- gamma = " << gamma << '\n';
         
-        _T.writePtree(psol, _solMap);
+        writeSolLabels(psol);
         
     }
 }
@@ -1011,11 +1396,205 @@ void Naive::writeContactSol(std::ostream& psol, const IntStringPairMatrix& sol)
 				int mu = computeInf();
 				int gamma = computeCoInf();
 				
-				std::cout << i << "\t" << _solMap[_T.root()] + 1 << "\t" << mu << "\t" << gamma << std::endl;
-				psol << "# idx = " << i << " -- root = " << _solMap[_T.root()] + 1 << " -- mu = " << mu << " -- gamma = " << gamma << std::endl;
+				if (!_quiet)
+				{
+						_log << i << "\t" << _solMap[_T.root()] + 1 << "\t" << mu << "\t" << gamma << '\n';
+				}
+				psol << "# idx = " << i << " -- root = " << _solMap[_T.root()] + 1 << " -- mu = " << mu << " -- gamma = " << gamma << '\n';
+				
+				writeSolLabels(psol);
 				
-				_T.writePtree(psol, _solMap);
+		}
+}
+
+void Naive::countContactTransTrees(IntVectorToUInt64HashMap& transTrees)
+{
+		Node root = _T.root();
+		const int nrInfectedHosts = _T.getNrHost();
+		
+		Digraph::NodeMap<std::vector<IntVectorToUInt64HashMap>> charts(tree());
+		runContactTransTrees(root, charts);
+		
+		for (int s = 0; s < nrInfectedHosts; ++s)
+		{
+				if (_rootLabel != -1 && s != _rootLabel)
+				{
+						continue;
+				}
+				
+				for (const auto& kv : charts[root][s])
+				{
+						transTrees[kv.first] += kv.second;
+				}
+		}
+		
+		_log << "Number of distinct contact-constrained transmission trees is: " << transTrees.size() << std::endl;
+}
+
+void Naive::runContactTransTrees(Node u, Digraph::NodeMap<std::vector<IntVectorToUInt64HashMap>>& charts)
+{
+		const Digraph& G = tree();
+		const Digraph& C = _T.contactMap();
+		const int nrInfectedHosts = _T.getNrHost();
+		
+		for (Digraph::OutArcIt a(G, u); a != lemon::INVALID; ++a)
+		{
+				runContactTransTrees(G.target(a), charts);
+		}
+		
+		charts[u] = std::vector<IntVectorToUInt64HashMap>(nrInfectedHosts);
+		
+		for (int s = 0; s < nrInfectedHosts; ++s)
+		{
+				if (_N[u][s] == 0)
+				{
+						continue;
+				}
+				
+				IntVectorToUInt64HashMap chart;
+				chart[IntVector()] = 1;
+				
+				Node sHost = _T.getContactNode(s);
+				
+				for (Digraph::OutArcIt a(G, u); a != lemon::INVALID; ++a)
+				{
+						Node v = G.target(a);
+						
+						// partial trees of the subtree of v including the arc (u,v)
+						IntVectorToUInt64HashMap childChart;
+						for (const auto& kv : charts[v][s])
+						{
+								childChart[kv.first] += kv.second;
+						}
+						
+						for (Digraph::OutArcIt e(C, sHost); e != lemon::INVALID; ++e)
+						{
+								int t = _T.getContactIndex(C.target(e));
+								int st = s * nrInfectedHosts + t;
+								
+								for (const auto& kv : charts[v][t])
+								{
+										IntVector key(kv.first);
+										key.insert(std::upper_bound(key.begin(), key.end(), st), st);
+										childChart[key] += kv.second;
+								}
+						}
+						
+						IntVectorToUInt64HashMap newChart;
+						for (const auto& kv1 : chart)
+						{
+								for (const auto& kv2 : childChart)
+								{
+										IntVector key;
+										key.reserve(kv1.first.size() + kv2.first.size());
+										std::merge(kv1.first.begin(), kv1.first.end(),
+															 kv2.first.begin(), kv2.first.end(),
+															 std::back_inserter(key));
+										newChart[key] += kv1.second * kv2.second;
+								}
+						}
+						chart.swap(newChart);
+				}
+				
+				charts[u][s].swap(chart);
+		}
+		
+		for (Digraph::OutArcIt a(G, u); a != lemon::INVALID; ++a)
+		{
+				std::vector<IntVectorToUInt64HashMap>().swap(charts[G.target(a)]);
+		}
+}
+
+void Naive::addTransTree(IntVectorToUInt64HashMap& transTrees) const
+{
+		const Digraph& G = tree();
+		const int nrInfectedHosts = _T.getNrHost();
+		
+		IntVector key;
+		for (ArcIt a(G); a != lemon::INVALID; ++a)
+		{
+				int s = _solMap[G.source(a)];
+				int t = _solMap[G.target(a)];
+				
+				if (s != t)
+				{
+						key.push_back(s * nrInfectedHosts + t);
+				}
+		}
+		std::sort(key.begin(), key.end());
+		
+		++transTrees[key];
+}
+
+void Naive::writeTransTrees(std::ostream& out, const IntVectorToUInt64HashMap& transTrees) const
+{
+		const int nrInfectedHosts = _T.getNrHost();
+		
+		std::vector<IntVectorToUInt64HashMap::const_iterator> order;
+		for (auto it = transTrees.begin(); it != transTrees.end(); ++it)
+		{
+				order.push_back(it);
+		}
+		std::sort(order.begin(), order.end(),
+							[](IntVectorToUInt64HashMap::const_iterator a, IntVectorToUInt64HashMap::const_iterator b)
+							{
+									return a->second > b->second || (a->second == b->second && a->first < b->first);
+							});
+		
+		out << order.size() << " # trans trees" << '\n';
+		for (int idx = 0; idx < order.size(); ++idx)
+		{
+				const IntVector& arcs = order[idx]->first;
+				
+				// the equal arcs are consecutive in the sorted multiset
+				IntPairVector edges;
+				for (int i = 0; i < arcs.size(); ++i)
+				{
+						if (i == 0 || arcs[i] != arcs[i - 1])
+						{
+								edges.push_back(std::make_pair(arcs[i], 1));
+						}
+						else
+						{
+								++edges.back().second;
+						}
+				}
 				
+				out << edges.size() << " # edges, tree " << idx << ", count " << order[idx]->second << '\n';
+				for (const IntPair& edge : edges)
+				{
+						int s = edge.first / nrInfectedHosts;
+						int t = edge.first % nrInfectedHosts;
+						out << _T.getContactName(s) << " " << _T.getContactName(t) << " " << edge.second << '\n';
+				}
+		}
+}
+
+void Naive::writeSolLabels(std::ostream& psol)
+{
+		if (!_deltaOutput || !_hasPrevSol)
+		{
+				_T.writePtree(psol, _solMap);
+		}
+		else
+		{
+				// only the internal nodes whose label changed
+				for (NodeIt vi(tree()); vi != lemon::INVALID; ++vi)
+				{
+						if (_solMap[vi] != _prevSolMap[vi])
+						{
+								psol << name(vi) << "\t" << _solMap[vi] + 1 << '\n';
+						}
+				}
+		}
+		
+		if (_deltaOutput)
+		{
+				for (NodeIt vi(tree()); vi != lemon::INVALID; ++vi)
+				{
+						_prevSolMap[vi] = _solMap[vi];
+				}
+				_hasPrevSol = true;
 		}
 }
 
@@ -1072,8 +1651,10 @@ IntStringPairMatrix Naive::enumerateSol(Node u, int label)
         sizes[i] = chartChildren[i].size();
     }
     
-     // merge chartChildren into chart
+     // merge chartChildren into chart in reflected Gray code order,
+     // consecutive entries differ in the subtree of a single child
     UInt64Vector indices(nrChildren_u, 0);
+    IntVector directions(nrChildren_u, 1);
     do
     {
         IntStringPairVector solInstance;
@@ -1088,7 +1669,7 @@ IntStringPairMatrix Naive::enumerateSol(Node u, int label)
         solInstance.push_back(std::make_pair(label, _T.getName(u)));
         
         chart.push_back(solInstance);
-    } while (next(sizes, indices));
+    } while (nextGray(sizes, indices, directions));
     
     // assert that size of chart is consistent
     
@@ -1151,8 +1732,10 @@ IntStringPairMatrix Naive::enumerateContactSol(Node u, int s)
 				sizes[i] = chartChildren[i].size();
 		}
 		
-		// merge chartChildren into chart
+		// merge chartChildren into chart in reflected Gray code order,
+		// consecutive entries differ in the subtree of a single child
 		UInt64Vector indices(nrChildren_u, 0);
+		IntVector directions(nrChildren_u, 1);
 		do
 		{
 				IntStringPairVector solInstance;
@@ -1167,7 +1750,7 @@ IntStringPairMatrix Naive::enumerateContactSol(Node u, int s)
 				solInstance.push_back(std::make_pair(s, _T.getName(u)));
 				
 				chart.push_back(solInstance);
-		} while (next(sizes, indices));
+		} while (nextGray(sizes, indices, directions));
 		
 		// assert that size of chart is consistent
 		
@@ -1201,6 +1784,33 @@ bool Naive::next(const UInt64Vector& sizes, UInt64Vector& indices)
     return true;
 }
 
+bool Naive::nextGray(const UInt64Vector& sizes, UInt64Vector& indices, IntVector& directions)
+{
+    assert(sizes.size() == indices.size() && sizes.size() == directions.size());
+    
+    const int n = sizes.size();
+    
+    // move the first index that can move in its direction,
+    // the indices before it are at their end and turn around
+    for (int i = 0; i < n; ++i)
+    {
+        if (directions[i] > 0 && indices[i] < sizes[i] - 1)
+        {
+            ++indices[i];
+            return true;
+        }
+        else if (directions[i] < 0 && indices[i] > 0)
+        {
+            --indices[i];
+            return true;
+        }
+        
+        directions[i] = -directions[i];
+    }
+    
+    return false;
+}
+
 int Naive::computeCoInf()
 {
     const Digraph& G = tree();
@@ -1277,7 +1887,7 @@ int Naive::computeInf()
 		return mu;
 }
 
-bool Naive::solve(std::ostream &psol, bool enumerate, uint64_t enumLimit)
+bool Naive::checkInput(std::ostream& psol)
 {
     // check if root label is out of bound
     // check if root host is possible
@@ -1313,6 +1923,26 @@ bool Naive::solve(std::ostream &psol, bool enumerate, uint64_t enumLimit)
         }
     }
     
+    return true;
+}
+
+uint64_t Naive::countContactSolutions(std::ostream& psol)
+{
+		if (!checkInput(psol))
+		{
+				return 0;
+		}
+		
+		return countContact();
+}
+
+bool Naive::solve(std::ostream &psol, bool enumerate, uint64_t enumLimit)
+{
+    if (!checkInput(psol))
+    {
+        return false;
+    }
+    
     // solve the problem
     if (!enumerate) {
         if (solveSankoff())
@@ -1347,40 +1977,11 @@ bool Naive::solve(std::ostream &psol)
 {
     // finds the sankoff consensus solution
     
-    // check if root label is out of bound
-    // check if root host is possible
-    if (_rootLabel >= _T.getNrHost() || _rootLabel < -1)
+    if (!checkInput(psol))
     {
-        std::cerr << "root label is out of bounds" << std::endl;
         return false;
     }
     
-    if (_rootLabel > -1)
-    {
-        if (_T.getEntTime(_rootLabel) > _T.getTime(root()) || _T.getRemTime(_rootLabel) < _T.getTime(root()))
-        {
-            _T.writePtree(psol, "infeasible root");
-            std::cerr << "value of root label is " << _rootLabel + 1 << std::endl;
-            std::cerr << "not a feasible root" << std::endl;
-            return false;
-        }
-    }
-    
-    // check if leaf labels are feasible
-    for (NodeIt vi(_T.tree()); vi != lemon::INVALID; ++vi)
-    {
-        if (lemon::countOutArcs(_T.tree(), vi) == 0)
-        {
-            int lhost = _T.getHostLabel(vi);
-            if (_T.getEntTime(lhost) > _T.getTime(vi) || _T.getRemTime(lhost) < _T.getTime(vi))
-            {
-                _T.writePtree(psol, "infeasible root labeling in ptree");
-                std::cerr << "label of leaf " << _T.getName(vi) << " is wrong" << std::endl;
-                return false;
-            }
-        }
-    }
-    
     // solve the problem
     if (solveConsensus())
     {
@@ -1400,40 +2001,11 @@ bool Naive::solveContact(std::ostream &psol, uint64_t enumLimit)
 {
 		// finds and enumerates the contact-constrained vertex labels
 		
-		// check if root label is out of bound
-		// check if root host is possible
-		if (_rootLabel >= _T.getNrHost() || _rootLabel < -1)
+		if (!checkInput(psol))
 		{
-				std::cerr << "root label is out of bounds" << std::endl;
 				return false;
 		}
 		
-		if (_rootLabel > -1)
-		{
-				if (_T.getEntTime(_rootLabel) > _T.getTime(root()) || _T.getRemTime(_rootLabel) < _T.getTime(root()))
-				{
-						_T.writePtree(psol, "infeasible root");
-						std::cerr << "value of root label is " << _rootLabel + 1 << std::endl;
-						std::cerr << "not a feasible root" << std::endl;
-						return false;
-				}
-		}
-		
-		// check if leaf labels are feasible
-		for (NodeIt vi(_T.tree()); vi != lemon::INVALID; ++vi)
-		{
-				if (lemon::countOutArcs(_T.tree(), vi) == 0)
-				{
-						int lhost = _T.getHostLabel(vi);
-						if (_T.getEntTime(lhost) > _T.getTime(vi) || _T.getRemTime(lhost) < _T.getTime(vi))
-						{
-								_T.writePtree(psol, "infeasible root labeling in ptree");
-								std::cerr << "label of leaf " << _T.getName(vi) << " is wrong" << std::endl;
-								return false;
-						}
-				}
-		}
-		
 		uint64_t nsols = countContact();
 		
 		if (nsols > 0)
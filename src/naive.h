@@ -7,12 +7,15 @@
 
 #include "utils.h"
 #include "basetree.h"
+#include "transmissionstats.h"
 #include <fstream>
+#include <memory>
 
 class Naive
 {
 public:
-    Naive(const BaseTree& T, const int rootLabel);
+    /// the progress and results of the solver are reported on log
+    Naive(const BaseTree& T, const int rootLabel, std::ostream& log = std::cout);
     
     /// initialize the solver
     void init();
@@ -50,8 +53,78 @@ public:
 		/// over contact-constrained solution space
 		void getContactSample();
 		
+		/// count the contact-constrained solutions without writing them
+		/// (returns 0 if the root or leaf labels are infeasible)
+		uint64_t countContactSolutions(std::ostream& psol);
+		
+		/// count the contact-constrained solutions up to permutation of the
+		/// unsampled hosts (requires interchangeable unsampled hosts, see
+		/// BaseTree::unsampledHostsInterchangeable, and a sampled root label)
+		/// returns 0 if there is no solution or the hosts are not interchangeable
+		uint64_t countContactReduced(std::ostream& psol);
+		
+		/// get sample from uniform distribution over the contact-constrained
+		/// solutions up to permutation of the unsampled hosts
+		/// (requires countContactReduced); the unsampled hosts of the sample
+		/// are labeled canonically
+		void getContactReducedSample();
+		
+		/// count the contact-constrained labelings of every distinct transmission
+		/// tree (requires the contact-constrained count). A transmission tree is
+		/// the sorted multiset of its s->t arcs, each encoded as s * nrHosts + t
+		void countContactTransTrees(IntVectorToUInt64HashMap& transTrees);
+		
+		/// add one to the count of the transmission tree of the solution map
+		void addTransTree(IntVectorToUInt64HashMap& transTrees) const;
+		
+		/// write the transmission trees and their counts, by decreasing count
+		void writeTransTrees(std::ostream& out, const IntVectorToUInt64HashMap& transTrees) const;
+		
+		/// write every enumerated solution after the first one as the
+		/// (node, label) pairs that changed since the previous solution
+		void setDeltaOutput(bool deltaOutput)
+		{
+				_deltaOutput = deltaOutput;
+		}
+		
+		/// suppress the per-solution console output of the enumeration
+		void setQuiet(bool quiet)
+		{
+				_quiet = quiet;
+		}
+		
+		/// use the given random number generator for sampling (default: g_rng)
+		void setRandomGenerator(std::mt19937& rng)
+		{
+				_rng = &rng;
+		}
+		
+		/// add the expected number of s->t transmission arcs and the number of
+		/// contact-constrained labelings using each contact arc to stats
+		/// (requires the contact-constrained count)
+		void accumulateTransmissionStats(TransmissionStats& stats);
+		
+		/// update the contact-constrained count after a leaf has been grafted
+		/// onto the tree (BaseTree::insertLeaf), recomputing only the charts
+		/// on the path from the new leaf to the root
+		/// @param leaf Newly inserted leaf
+		uint64_t updateContactCount(Node leaf);
+		
+		/// update the Sankoff count after a leaf has been grafted onto the tree,
+		/// recomputing only the charts on the path from the new leaf to the root.
+		/// The instance weights (_W) are not refreshed.
+		/// @param leaf Newly inserted leaf
+		uint64_t updateSankoffCount(Node leaf);
+		
 protected:
     bool next(const UInt64Vector& sizes, UInt64Vector& indices);
+    
+    /// advance indices in reflected mixed-radix Gray code order,
+    /// changing a single index by one per step
+    bool nextGray(const UInt64Vector& sizes, UInt64Vector& indices, IntVector& directions);
+    
+    /// check that the root label and the leaf labels are feasible
+    bool checkInput(std::ostream& psol);
 
 		/// contact-constrained functions
 		uint64_t countContact();
@@ -63,11 +136,45 @@ protected:
 		IntStringPairMatrix enumerateContactSol(Node u, int label);
 		
 		void runContactCount(Node u);
+		
+		/// fill the contact-constrained chart N of the subtree of u
+		/// without using the excluded contact arc, labeling the internal
+		/// nodes only by hosts with index less than nrAllowedHosts
+		void runContactCount(Node u, UInt64VectorNodeMap& N, Arc excluded, int nrAllowedHosts);
+		
+		/// compute the contact-constrained chart of a single node
+		/// from the charts of its children
+		/// @param u Node
+		void computeContactCount(Node u);
+		
+		/// compute the contact-constrained chart N of a single node
+		/// without using the excluded contact arc, labeling the internal
+		/// nodes only by hosts with index less than nrAllowedHosts
+		void computeContactCount(Node u, UInt64VectorNodeMap& N, Arc excluded, int nrAllowedHosts);
+		
+		/// fill the transmission tree charts of the subtree of u, i.e. for each
+		/// label of u the number of labelings of each partial transmission tree;
+		/// the charts of the children are released once merged into u
+		void runContactTransTrees(Node u, Digraph::NodeMap<std::vector<IntVectorToUInt64HashMap>>& charts);
+		
+		/// return the number of contact-constrained solutions in chart N
+		uint64_t getContactRootCount(const UInt64VectorNodeMap& N) const;
 
 		void writeContactSol(std::ostream& psol, const IntStringPairMatrix& sol);
 		
+		/// write the labels of _solMap, either in full or
+		/// as the changes to the previously written solution
+		void writeSolLabels(std::ostream& psol);
+		
 		void getContactSample(Node u, int label);
 		
+		/// sample the labels of the subtree of u from chart N
+		void getContactSample(Node u, int label, const UInt64VectorNodeMap& N);
+		
+		/// relabel the unsampled hosts in the order of their first
+		/// occurrence in a pre-order traversal of the tree
+		void canonizeUnsampledHosts(IntNodeMap& label) const;
+		
     /// solve Sankoff
     bool solveSankoff();
 		
@@ -84,11 +191,19 @@ protected:
   
     /// count the number of Sankoff solutions
     uint64_t countSankoff();
+    
+    /// count the number of Sankoff solutions from the root chart
+    uint64_t countSankoffRoot();
 		
     /// Solve for the number of Sankoff solutions
     /// (dynamic programming)
     /// @param u Node
     void runCount(Node u);
+    
+    /// compute the parsimony and count charts of a single node
+    /// from the charts of its children
+    /// @param u Node
+    void computeCount(Node u);
 		
     /// compute the number of instances of Sankoff solutions
     /// with particular node label
@@ -223,6 +338,8 @@ protected:
         
 protected:
     const BaseTree& _T;
+    /// stream of the console output
+    std::ostream& _log;
     /// root label
     const int _rootLabel;
     /// Solution vertex labeling
@@ -237,6 +354,22 @@ protected:
     UInt64VectorNodeMap _G;
     /// number of Sankoff solutions
     uint64_t _numSols;
+    /// random number generator used for sampling
+    std::mt19937* _rng;
+    /// contact-constrained charts restricted to the first j unsampled hosts
+    std::vector<std::unique_ptr<UInt64VectorNodeMap>> _restrictedN;
+    /// number of solutions up to permutation using exactly j unsampled hosts
+    UInt64Vector _reducedCounts;
+    /// number of solutions up to permutation of the unsampled hosts
+    uint64_t _numReducedSols;
+    /// write enumerated solutions as changes to the previous one
+    bool _deltaOutput;
+    /// suppress per-solution console output
+    bool _quiet;
+    /// previously written solution (delta output)
+    IntNodeMap _prevSolMap;
+    /// whether a solution has been written (delta output)
+    bool _hasPrevSol;
 		
 		//lemon::ArcLookUp<Digraph> _contactLookUp;
 };
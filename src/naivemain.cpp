@@ -25,7 +25,12 @@ int main(int argc, char** argv)
     bool enumerate = false;
     bool consensus = false;
 		bool parsimony = false;
+		bool reduce = false;
+		bool delta = false;
+		bool quiet = false;
+		bool transTrees = false;
 		std::string contactmap_filename;
+		std::string graft_filename;
     int enumLimit = std::numeric_limits<int>::max();
     
     lemon::ArgParser ap(argc, argv);
@@ -37,6 +42,11 @@ int main(int argc, char** argv)
     ap.refOption("e", "Enumerate all the solutions (default: false)", enumerate);
     ap.refOption("c", "Find consensus Sankoff solution (deafault: false)", consensus);
     ap.refOption("l", "Enumeration solution number limit (default: intMax)", enumLimit);
+		ap.refOption("d", "Write enumerated solutions as changes to the previous one (default: false)", delta);
+		ap.refOption("x", "Count the labelings of each distinct transmission tree (default: false)", transTrees);
+		ap.refOption("q", "Suppress per-solution console output (default: false)", quiet);
+		ap.refOption("y", "Count up to permutation of unsampled hosts (default: false)", reduce);
+		ap.refOption("g", "Graft file with leaves to insert and recount (default: empty)", graft_filename);
     ap.other("<host> / <transmission_tree>");
     ap.other("<ptree>");
     ap.other("<output_ptree>");
@@ -122,13 +132,53 @@ int main(int argc, char** argv)
 				return 1;
 		}
 		
+		if (!graft_filename.empty() && (consensus || (parsimony && !enumerate)))
+		{
+				std::cerr << "Error8: grafting requires counting, use -e together with -p" << std::endl;
+				return 1;
+		}
+		
+		if (reduce && (parsimony || enumerate || !graft_filename.empty()))
+		{
+				std::cerr << "Error10: counting up to permutation of unsampled hosts requires contact-constrained solutions without -e and -g" << std::endl;
+				return 1;
+		}
+		
+		if (transTrees && (parsimony || enumerate || reduce || !graft_filename.empty()))
+		{
+				std::cerr << "Error11: transmission trees require contact-constrained solutions without -e, -y and -g" << std::endl;
+				return 1;
+		}
+		
     Naive solver(B, rootLabel - 1);
+		solver.setDeltaOutput(delta);
+		solver.setQuiet(quiet);
 		
 		if (!parsimony)
 		{
 				solver.initContact();
 				
-				if (!enumerate)
+				if (transTrees)
+				{
+						IntVectorToUInt64HashMap transTreeCounts;
+						if (solver.countContactSolutions(ptree_sol) > 0)
+						{
+								solver.countContactTransTrees(transTreeCounts);
+						}
+						solver.writeTransTrees(ptree_sol, transTreeCounts);
+				}
+				else if (reduce)
+				{
+						// write a canonical representative of a random orbit
+						uint64_t nsols = solver.countContactReduced(ptree_sol);
+						if (nsols > 0)
+						{
+								solver.getContactReducedSample();
+								B.writePtree(ptree_sol, solver.getSolMap());
+								ptree_sol << "# reduced count = " << nsols << std::endl;
+						}
+				}
+				else if (!enumerate)
 				{
 						solver.solveContact(ptree_sol, 1);
 				}
@@ -151,6 +201,53 @@ int main(int argc, char** argv)
 				}
 		}
 		
+		if (!graft_filename.empty())
+		{
+				std::ifstream graft_file(graft_filename.c_str());
+				if (!graft_file.good())
+				{
+						std::cerr << "Error9: failed opening '" << graft_filename << "' for reading" << std::endl;
+						return 1;
+				}
+				
+				// each line: <node> <parent time> <leaf time> <host label>
+				while (graft_file.good())
+				{
+						std::string line;
+						getline(graft_file, line);
+						
+						if (line.empty())
+								break;
+						
+						StringVector s;
+						boost::split(s, line, boost::is_any_of("\t "));
+						
+						if (s.size() != 4)
+						{
+								std::cerr << "Error: line '" << line << "' incorrect number of columns" << std::endl;
+								return 1;
+						}
+						
+						Node v = B.getNodeByLabel(s[0]);
+						if (v == lemon::INVALID)
+						{
+								std::cerr << "Error: line '" << line << "' node " << s[0] << " not found in the ptree" << std::endl;
+								return 1;
+						}
+						
+						Node leaf = B.insertLeaf(v, std::stod(s[1]), std::stod(s[2]), std::stoi(s[3]) - 1);
+						if (leaf == lemon::INVALID)
+						{
+								return 1;
+						}
+						
+						uint64_t nsols = parsimony ? solver.updateSankoffCount(leaf) : solver.updateContactCount(leaf);
+						ptree_sol << "# graft = " << B.getName(leaf) << " -- count = " << nsols << std::endl;
+				}
+				
+				graft_file.close();
+		}
+		
     ptree_sol.close();
     
     return 0;
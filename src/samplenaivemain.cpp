@@ -23,12 +23,16 @@ int main(int argc, char** argv)
     int nrUnsampledHosts = 0;
     int sampleLimit = 11000;
 		std::string contactmap_filename;
+		bool reduce = false;
+		bool transTrees = false;
   
     lemon::ArgParser ap(argc, argv);
     ap.refOption("r", "Root label (default: 0)", rootLabel);
 		ap.refOption("m", "Contact map file: (default: empty)", contactmap_filename);
     ap.refOption("u", "Number of unsampled hosts (default: 0)", nrUnsampledHosts);
     ap.refOption("l", "Number of samples (default: 11000)", sampleLimit);
+		ap.refOption("x", "Aggregate the samples by transmission tree (default: false)", transTrees);
+		ap.refOption("y", "Sample up to permutation of unsampled hosts (default: false)", reduce);
     ap.other("<host>");
     ap.other("<ptree>");
     ap.other("<output_prefix>");
@@ -96,14 +100,39 @@ int main(int argc, char** argv)
   
     Naive solver(B, rootLabel - 1);
     solver.initContact();
-    solver.solveContact(std::cout, 0);
+		if (reduce)
+		{
+				if (solver.countContactReduced(std::cout) == 0)
+				{
+						return 1;
+				}
+		}
+		else
+		{
+				solver.solveContact(std::cout, 0);
+		}
 	
 		IntPairSetIntMap solutionMap;
+		IntVectorToUInt64HashMap transTreeCounts;
     char buf[1024];
 		
 		for (int count = 0; count < sampleLimit; ++count)
     {
-        solver.getContactSample();
+				if (reduce)
+				{
+						solver.getContactReducedSample();
+				}
+				else
+				{
+						solver.getContactSample();
+				}
+				
+				if (transTrees)
+				{
+						solver.addTransTree(transTreeCounts);
+						continue;
+				}
+				
 				const IntNodeMap& ell = solver.getSolMap();
 		
 				IntPairSet sampleSolution;
@@ -124,6 +153,22 @@ int main(int argc, char** argv)
 				}
     }
 	
+		if (transTrees)
+		{
+				std::string transtrees_filename = output_prefix + "transtrees.out";
+				std::ofstream outTransTrees(transtrees_filename.c_str());
+				if (!outTransTrees.good())
+				{
+						std::cerr << "Error5: failed opening '" << transtrees_filename << "' for writing" << std::endl;
+						return 1;
+				}
+				
+				solver.writeTransTrees(outTransTrees, transTreeCounts);
+				outTransTrees.close();
+				
+				return 0;
+		}
+		
 		int idx = 0;
 	
 		for (const auto& sol_count : solutionMap )
@@ -256,17 +256,23 @@ bool ScttSolver::readTransmissionTrees(std::istream& in)
   getline(in, line);
 
   std::stringstream ss(line);
-  int nrTrees = -1;
+  int nrTrees = -2;
   ss >> nrTrees;
-  if (nrTrees < 0)
+  if (nrTrees < -1)
   {
     std::cerr << "error: incorrect number of transmission trees" << std::endl;
     return false;
   }
 
-  for (int treeIdx = 0; treeIdx < nrTrees; ++treeIdx)
+  // -1 trees are written by unigenparser -stream to a non-seekable
+  // output, the trees are then read up to the end of the input
+  for (int treeIdx = 0; nrTrees == -1 || treeIdx < nrTrees; ++treeIdx)
   {
     getline(in, line);
+    if (nrTrees == -1 && !in.good())
+    {
+      break;
+    }
 
     std::stringstream ss(line);
     int nrEdges = -1;
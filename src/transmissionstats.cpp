@@ -0,0 +1,68 @@
+/*
+ * transmissionstats.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: P. Sashittal
+ */
+
+#include "transmissionstats.h"
+
+TransmissionStats::TransmissionStats(int nrHosts)
+    : _nrHosts(nrHosts)
+    , _nrTrees(0)
+    , _nrLabelings(0)
+    , _transmissions(nrHosts, DoubleVector(nrHosts, 0))
+    , _usage(nrHosts, DoubleVector(nrHosts, 0))
+{
+}
+
+void TransmissionStats::add(double nrLabelings,
+                            const DoubleMatrix& transmissions,
+                            const DoubleMatrix& usage)
+{
+    assert(transmissions.size() == _nrHosts && usage.size() == _nrHosts);
+
+    ++_nrTrees;
+    _nrLabelings += nrLabelings;
+
+    for (int s = 0; s < _nrHosts; ++s)
+    {
+        for (int t = 0; t < _nrHosts; ++t)
+        {
+            _transmissions[s][t] += transmissions[s][t];
+            _usage[s][t] += usage[s][t];
+        }
+    }
+}
+
+void TransmissionStats::merge(const TransmissionStats& other)
+{
+    assert(other._nrHosts == _nrHosts);
+
+    _nrTrees += other._nrTrees;
+    _nrLabelings += other._nrLabelings;
+
+    for (int s = 0; s < _nrHosts; ++s)
+    {
+        for (int t = 0; t < _nrHosts; ++t)
+        {
+            _transmissions[s][t] += other._transmissions[s][t];
+            _usage[s][t] += other._usage[s][t];
+        }
+    }
+}
+
+void TransmissionStats::writeStats(std::ostream& out, const BaseTree& T) const
+{
+    const Digraph& C = T.contactMap();
+
+    out << "source" << "\t" << "target" << "\t" << "expectedTransmissions" << "\t" << "probability" << std::endl;
+
+    for (ArcIt est(C); est != lemon::INVALID; ++est)
+    {
+        int s = T.getContactIndex(C.source(est));
+        int t = T.getContactIndex(C.target(est));
+
+        out << T.getContactName(s) << "\t" << T.getContactName(t) << "\t" << getExpectedTransmissions(s, t) << "\t" << getUsageProbability(s, t) << std::endl;
+    }
+}
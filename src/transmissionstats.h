@@ -0,0 +1,78 @@
+/*
+ * transmissionstats.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: P. Sashittal
+ */
+
+#ifndef TRANSMISSIONSTATS_H
+#define TRANSMISSIONSTATS_H
+
+#include "utils.h"
+#include "basetree.h"
+
+/// This class accumulates transmission-pair statistics over the
+/// vertex labelings of one or more ptrees. Every labeling of every ptree
+/// has the same weight, so each ptree is weighted by its number of labelings.
+/// Instances are not thread-safe; use one per thread and merge them.
+class TransmissionStats
+{
+public:
+    /// constructor
+    ///
+    /// @param nrHosts Number of hosts (including unsampled hosts)
+    TransmissionStats(int nrHosts);
+
+    /// add the statistics of one ptree
+    ///
+    /// @param nrLabelings Number of labelings of the ptree
+    /// @param transmissions Number of s->t arcs summed over all labelings
+    /// @param usage Number of labelings with at least one s->t arc
+    void add(double nrLabelings,
+             const DoubleMatrix& transmissions,
+             const DoubleMatrix& usage);
+
+    /// merge the statistics accumulated by another instance
+    void merge(const TransmissionStats& other);
+
+    /// Return number of ptrees added
+    int getNrTrees() const
+    {
+        return _nrTrees;
+    }
+
+    /// Return total number of labelings
+    double getNrLabelings() const
+    {
+        return _nrLabelings;
+    }
+
+    /// Return expected number of s->t transmission arcs
+    double getExpectedTransmissions(int s, int t) const
+    {
+        return _nrLabelings > 0 ? _transmissions[s][t] / _nrLabelings : 0;
+    }
+
+    /// Return probability that s infects t
+    double getUsageProbability(int s, int t) const
+    {
+        return _nrLabelings > 0 ? _usage[s][t] / _nrLabelings : 0;
+    }
+
+    /// write the statistics of every arc of the contact map
+    void writeStats(std::ostream& out, const BaseTree& T) const;
+
+protected:
+    /// number of hosts
+    int _nrHosts;
+    /// number of ptrees
+    int _nrTrees;
+    /// number of labelings over all ptrees
+    double _nrLabelings;
+    /// number of s->t arcs summed over all labelings
+    DoubleMatrix _transmissions;
+    /// number of labelings in which s infects t
+    DoubleMatrix _usage;
+};
+
+#endif // TRANSMISSIONSTATS_H
@@ -6,18 +6,35 @@
  */
 
 #include "unigenparser.h"
+#include "mappedfile.h"
+#include <cstring>
+#include <thread>
+#include <atomic>
+#include <iomanip>
+
+/// width of the number of trees in the header of streamed transmission trees
+static const int streamHeaderWidth = 20;
+
+/// number of lines of a sample stream after which the solutions are written when streaming
+static const int streamPartSize = 1 << 14;
 
 UnigenParser::UnigenParser(const BaseTree& T,
 													 std::string trans_prefix)
 		: _T(T)
 		, _solMap(_T.tree())
     , _sampledHostMap(_T.tree())
-		, _nodeHostPair()
+		, _varLabels(nullptr)
+		, _nrContactStrains(0)
+		, _streamTT(nullptr)
+		, _streamS(nullptr)
+		, _streamHeaderPos(-1)
+		, _minChunkSize(1 << 20)
 		, _transPrefix(trans_prefix)
 		, _computeDist(false)
 		, _numVar()
 {
   initSampledHosts(_T.root());
+  initContactArcs();
 }
 
 UnigenParser::UnigenParser(const BaseTree& T,
@@ -26,13 +43,19 @@ UnigenParser::UnigenParser(const BaseTree& T,
 : _T(T)
 , _solMap(_T.tree())
 , _sampledHostMap(_T.tree())
-, _nodeHostPair()
+, _varLabels(nullptr)
+, _nrContactStrains(0)
+, _streamTT(nullptr)
+, _streamS(nullptr)
+, _streamHeaderPos(-1)
+, _minChunkSize(1 << 20)
 , _transPrefix(trans_prefix)
 , _computeDist(false)
 , _numVar()
 , _muMax(muMax)
 {
   initSampledHosts(_T.root());
+  initContactArcs();
 }
 
 UnigenParser::UnigenParser(const BaseTree& T,
@@ -42,39 +65,78 @@ UnigenParser::UnigenParser(const BaseTree& T,
 : _T(T)
 , _solMap(_T.tree())
 , _sampledHostMap(_T.tree())
-, _nodeHostPair()
+, _varLabels(nullptr)
+, _nrContactStrains(0)
+, _streamTT(nullptr)
+, _streamS(nullptr)
+, _streamHeaderPos(-1)
+, _minChunkSize(1 << 20)
 , _transPrefix(trans_prefix)
 , _computeDist(computeDist)
 , _numVar()
 , _muMax(muMax)
 {
   initSampledHosts(_T.root());
+  initContactArcs();
 }
 
 void UnigenParser::initSampledHosts(Node v)
 {
+  // hosts are indexed as in the contact map, which may list more hosts than sampled
+  _sampledHostMap[v] = BoolVector(std::max(_T.getNrHost(), lemon::countNodes(_T.contactMap())), false);
   if (OutArcIt(_T.tree(), v) == lemon::INVALID)
   {
     // this is a leaf
-    _sampledHostMap[v] = IntSet();
-    _sampledHostMap[v].insert(_T.getHostLabel(v));
+    _sampledHostMap[v][_T.getHostLabel(v)] = true;
   }
   else
   {
-    _sampledHostMap[v] = IntSet();
     for (OutArcIt a(_T.tree(), v); a != lemon::INVALID; ++a)
     {
       Node w = _T.tree().target(a);
       initSampledHosts(w);
-      _sampledHostMap[v].insert(_sampledHostMap[w].begin(), _sampledHostMap[w].end());
+      for (int s = 0; s < _sampledHostMap[w].size(); ++s)
+      {
+        if (_sampledHostMap[w][s])
+        {
+          _sampledHostMap[v][s] = true;
+        }
+      }
     }
   }
 }
 
+void UnigenParser::initContactArcs()
+{
+  const Digraph& C = _T.contactMap();
+  
+  for (ArcIt est(C); est != lemon::INVALID; ++est)
+  {
+    Transmission arc = {_T.getContactIndex(C.source(est)), _T.getContactIndex(C.target(est)), _T.getContactNumStrains(est)};
+    _contactArcs.push_back(arc);
+    _nrContactStrains += arc.count;
+  }
+  
+  std::sort(_contactArcs.begin(), _contactArcs.end(),
+            [](const Transmission& a, const Transmission& b) { return a.s < b.s || (a.s == b.s && a.t < b.t); });
+}
+
 bool UnigenParser::readVarFile(std::istream& in)
 {
 		int numvar = 0;
 		
+		// the names are resolved once, the labels are indices of this tree
+		_nodeByIndex.clear();
+		for (int i = 0; i < lemon::countNodes(_T.tree()); ++i)
+		{
+				_nodeByIndex.push_back(_T.getNode(i));
+		}
+		_hostByIndex.clear();
+		for (int s = 0; s < lemon::countNodes(_T.contactMap()); ++s)
+		{
+				_hostByIndex.push_back(s);
+		}
+		
 		while (in.good())
 		{
 				std::string line;
@@ -83,6 +145,20 @@ bool UnigenParser::readVarFile(std::istream& in)
 				if (line.empty())
 						break;
 				
+				// a DIMACS file with an embedded variable list
+				if (line.compare(0, 6, "c var ") == 0)
+				{
+						line = line.substr(6);
+				}
+				else if (line[0] == 'c')
+				{
+						continue;
+				}
+				else if (line[0] == 'p')
+				{
+						break;
+				}
+				
 				StringVector s;
 				boost::split(s, line, boost::is_any_of("\t "));
 				
@@ -92,47 +168,128 @@ bool UnigenParser::readVarFile(std::istream& in)
 						return false;
 				}
 				
-				if (s[3] == "(v,s)")
+				if (s[3] != "(v,s)")
 				{
-						_nodeHostPair.push_back(std::make_pair(s[1], s[2]));
-						++numvar;
+						break;
+				}
+				
+				Node u = _T.getNodeByLabel(s[1]);
+				Node hostNode = _T.getContactNode(s[2]);
+				VarMap::Entry label = {u != lemon::INVALID ? _T.getIndex(u) : -1,
+															 hostNode != lemon::INVALID ? _T.getContactIndex(hostNode) : -1};
+				
+				if (s[0] == "0")
+				{
+						// label fixed by preprocessing
+						_fixedLabels.push_back(label);
 				}
 				else
 				{
-						break;
+						_textVarLabels.push_back(label);
+						++numvar;
 				}
 		}
 		
+		_varLabels = _textVarLabels.data();
 		_numVar = numvar;
   
 		return true;
 }
 
+bool UnigenParser::readVarMap(const std::string& filename)
+{
+		if (!_varMap.open(filename))
+		{
+				std::cerr << "Error: '" << filename << "' is not a variable map" << std::endl;
+				return false;
+		}
+		
+		// the indices of the variable map are those of the tree read by dimacs
+		_nodeByIndex.clear();
+		for (const std::string& nodeName : _varMap.getNodeNames())
+		{
+				_nodeByIndex.push_back(_T.getNodeByLabel(nodeName));
+		}
+		_hostByIndex.clear();
+		for (const std::string& hostName : _varMap.getHostNames())
+		{
+				Node hostNode = _T.getContactNode(hostName);
+				_hostByIndex.push_back(hostNode != lemon::INVALID ? _T.getContactIndex(hostNode) : -1);
+		}
+		
+		_varLabels = _varMap.getVars();
+		_numVar = _varMap.getNrVars();
+		_fixedLabels.assign(_varMap.getFixed(), _varMap.getFixed() + _varMap.getNrFixed());
+		
+		return true;
+}
+
 void UnigenParser::writeTransTrees(std::ostream& out) const
 {
-    out << _transmissionCountVector.size() << " # trans trees" << std::endl;
-    for (int idx = 0; idx < _transmissionCountVector.size(); ++idx)
+    out << _stats.solIdx.size() << " # trans trees" << '\n';
+    writeTransTrees(out, _stats);
+}
+
+void UnigenParser::writeTransTrees(std::ostream& out, const SolutionStats& stats) const
+{
+    for (int idx = 0; idx < stats.transmissionEnd.size(); ++idx)
     {
-        out << _transmissionCountVector[idx].size() << " # edges, tree " << idx << std::endl;
-        for (const auto& kv : _transmissionCountVector[idx])
+        const size_t first = idx == 0 ? 0 : stats.transmissionEnd[idx - 1];
+        out << stats.transmissionEnd[idx] - first << " # edges, tree " << stats.solIdx[idx] << ", count " << stats.multiplicity[idx] << '\n';
+        for (size_t i = first; i < stats.transmissionEnd[idx]; ++i)
         {
-            int s = kv.first.first;
-            int t = kv.first.second;
-          
-            const std::string& sStr = _T.getContactName(s);
-            const std::string& tStr = _T.getContactName(t);
-            out << sStr << " " << tStr << " " << kv.second << std::endl;
+            const std::string& sStr = _T.getContactName(stats.transmissions[i].s);
+            const std::string& tStr = _T.getContactName(stats.transmissions[i].t);
+            out << sStr << " " << tStr << " " << stats.transmissions[i].count << '\n';
         }
     }
 }
 
+void UnigenParser::setStreaming(std::ostream& outTT, std::ostream* outS)
+{
+    _streamTT = &outTT;
+    _streamS = outS;
+    
+    // the number of trees is only known at the end, it is written over
+    // the padding if the output is seekable and is -1 otherwise
+    _streamHeaderPos = outTT.tellp();
+    if (_streamHeaderPos != std::streampos(-1))
+    {
+        outTT << std::string(streamHeaderWidth, ' ') << " # trans trees" << '\n';
+    }
+    else
+    {
+        outTT << -1 << " # trans trees" << '\n';
+    }
+    
+    if (_streamS != nullptr)
+    {
+        writeSummaryHeader(*_streamS, _computeDist);
+    }
+}
+
+void UnigenParser::finishStreaming()
+{
+    _streamTT->flush();
+    if (_streamHeaderPos != std::streampos(-1))
+    {
+        const std::streampos pos = _streamTT->tellp();
+        _streamTT->seekp(_streamHeaderPos);
+        *_streamTT << std::setw(streamHeaderWidth) << _stats.nrWritten;
+        _streamTT->seekp(pos);
+        _streamTT->flush();
+    }
+    
+    if (_streamS != nullptr)
+    {
+        _streamS->flush();
+    }
+}
+
 void UnigenParser::parseUnigen(std::istream& in)
 {
-    _transmissionCountVector.clear();
-		const Digraph& G = _T.tree();
-		const Digraph& C = _T.contactMap();
-		
-    int solIdx = 0;
+		SolutionStats stats;
+		IntVector literals;
 		while (in.good())
 		{
 				std::string line;
@@ -143,133 +300,544 @@ void UnigenParser::parseUnigen(std::istream& in)
 						break;
 				}
 				
-				for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+				int count;
+				scanLiterals(line.data(), line.data() + line.size(), literals, count);
+				addSample(_solMap, literals, count, stats);
+				
+				if (_streamTT != nullptr && stats.nrSolutions % streamPartSize == 0)
+				{
+						appendStats(stats);
+				}
+		}
+		
+		appendStats(stats);
+}
+
+void UnigenParser::parseUnigen(const std::vector<std::istream*>& in)
+{
+		// the i-th samples of the components together form the i-th solution,
+		// a line sampled count times stands for count consecutive samples
+		SolutionStats stats;
+		std::vector<IntVector> componentLiterals(in.size());
+		IntVector remaining(in.size(), 0);
+		IntVector literals;
+		while (!in.empty())
+		{
+				bool done = false;
+				
+				for (int k = 0; k < in.size() && !done; ++k)
 				{
-						if (lemon::countOutArcs(G, vi) == 0)
+						if (remaining[k] > 0)
 						{
-								_solMap[vi] = _T.getHostLabel(vi);
+								continue;
+						}
+						
+						std::string line;
+						if (!in[k]->good() || !getline(*in[k], line) || line.empty())
+						{
+								done = true;
 						}
 						else
 						{
-								_solMap[vi] = -1;
+								scanLiterals(line.data(), line.data() + line.size(), componentLiterals[k], remaining[k]);
 						}
 				}
 				
-				StringVector s;
-				boost::split(s, line, boost::is_any_of("\t "));
+				if (done)
+				{
+						break;
+				}
+				
+				const int count = *std::min_element(remaining.begin(), remaining.end());
+				literals.clear();
+				for (int k = 0; k < in.size(); ++k)
+				{
+						literals.insert(literals.end(), componentLiterals[k].begin(), componentLiterals[k].end());
+						remaining[k] -= count;
+				}
+				
+				addSample(_solMap, literals, count, stats);
+				
+				if (_streamTT != nullptr && stats.nrSolutions % streamPartSize == 0)
+				{
+						appendStats(stats);
+				}
+		}
+		
+		appendStats(stats);
+}
+
+bool UnigenParser::parseUnigen(const std::string& filename, int nrThreads)
+{
+		// pipes and other files that can not be mapped are read sequentially
+		MappedFile file;
+		if (!file.open(filename))
+		{
+				std::ifstream in(filename.c_str());
+				if (!in.good())
+				{
+						return false;
+				}
+				parseUnigen(in);
+				return true;
+		}
+		file.adviseSequential();
+		
+		// the samples end at the first empty line
+		const char* begin = file.data();
+		const char* end = begin + file.size();
+		if (begin != end && *begin == '\n')
+		{
+				end = begin;
+		}
+		else if (begin != end)
+		{
+				const char* emptyLine = static_cast<const char*>(memmem(begin, end - begin, "\n\n", 2));
+				if (emptyLine != nullptr)
+				{
+						end = emptyLine + 1;
+				}
+		}
+		
+		// line-aligned chunks of at least _minChunkSize (1 MB), a few per thread
+		// to balance the load, parsed in batches of 4 chunks per thread; when
+		// streaming, the chunks are 1 MB so that memory use does not grow with
+		// the samples
+		nrThreads = std::max(nrThreads, 1);
+		const size_t batchSize = 4 * nrThreads;
+		const size_t chunkSize = _streamTT != nullptr ? _minChunkSize : std::max<size_t>(_minChunkSize, (end - begin) / batchSize + 1);
+		
+		// every thread labels its own node map, they are created here as
+		// creating a map registers it with the graph
+		std::vector<std::unique_ptr<IntNodeMap>> solMaps;
+		for (int i = 0; i < nrThreads; ++i)
+		{
+				solMaps.emplace_back(new IntNodeMap(_T.tree()));
+		}
+		
+		int nrSolutions = 0;
+		for (const char* batchBegin = begin; batchBegin != end;)
+		{
+				std::vector<const char*> bounds(1, batchBegin);
+				while (bounds.size() <= batchSize && bounds.back() != end)
+				{
+						const char* p = bounds.back() + std::min<size_t>(chunkSize, end - bounds.back());
+						const char* newline = static_cast<const char*>(memchr(p, '\n', end - p));
+						bounds.push_back(newline != nullptr ? newline + 1 : end);
+				}
+				batchBegin = bounds.back();
 				
-				for (int i = 0; i < _numVar; ++i)
+				// the solutions of chunk k are numbered from 0 in stats[k]
+				const size_t nrChunks = bounds.size() - 1;
+				std::vector<SolutionStats> stats(nrChunks);
+				std::atomic<size_t> nextChunk(0);
+				auto parseChunks = [&](int thread)
 				{
-						std::string varId = s[i];
+						IntNodeMap& solMap = *solMaps[thread];
+						IntVector literals;
+						int count;
 						
-						if (varId.at(0) != '-')
+						for (size_t k = nextChunk++; k < nrChunks; k = nextChunk++)
 						{
-								int varIndex = std::stoi(varId) - 1;
-								
-								std::string nodeName = _nodeHostPair[varIndex].first;
-								std::string hostName = _nodeHostPair[varIndex].second;
-								
-								Node u = _T.getNodeByLabel(nodeName);
-								Node hostNode = _T.getContactNode(hostName);
-								int hostIndex = _T.getContactIndex(hostNode);
-								
-								_solMap[u] = hostIndex;
+								const char* p = bounds[k];
+								while (p < bounds[k + 1])
+								{
+										p = scanLiterals(p, bounds[k + 1], literals, count);
+										addSample(solMap, literals, count, stats[k]);
+								}
+						}
+				};
+				
+				const int nrBatchThreads = std::min<int>(nrThreads, nrChunks);
+				if (nrBatchThreads == 1)
+				{
+						parseChunks(0);
+				}
+				else
+				{
+						std::vector<std::thread> threads;
+						for (int i = 0; i < nrBatchThreads; ++i)
+						{
+								threads.emplace_back(parseChunks, i);
+						}
+						for (std::thread& thread : threads)
+						{
+								thread.join();
 						}
 				}
-      
-        // we have a solution now, update transmission counts
-				std::map<std::pair<int, int>, int> currTransmissionCount;
-				int mu = 0;
-        int lambda = 0;
-        for (ArcIt a_ij(G); a_ij != lemon::INVALID; ++a_ij)
-        {
-          Node v_i = G.source(a_ij);
-          Node v_j = G.target(a_ij);
+				
+				// merge in chunk order, numbering the solutions after those of the previous chunks,
+				// a solution of several chunks keeps the position and index of its first occurrence
+				for (SolutionStats& chunkStats : stats)
+				{
+						for (int& solIdx : chunkStats.solIdx)
+						{
+								solIdx += nrSolutions;
+						}
+						nrSolutions += chunkStats.nrSolutions;
+						appendStats(chunkStats);
+				}
+		}
+		
+		return true;
+}
+
+const char* UnigenParser::scanLiterals(const char* p, const char* end, IntVector& literals, int& count)
+{
+		literals.clear();
+		count = 1;
+		
+		// UniGen prefixes the literals of a solution with 'v', as in "v1 -2 3 0:9"
+		while (p != end && (*p == ' ' || *p == '\t'))
+		{
+				++p;
+		}
+		if (p != end && *p == 'v')
+		{
+				++p;
+		}
+		
+		while (p != end && *p != '\n')
+		{
+				if (*p == ' ' || *p == '\t' || *p == '\r')
+				{
+						++p;
+						continue;
+				}
+				
+				const bool negative = *p == '-';
+				const char* q = negative ? p + 1 : p;
+				if (q != end && '0' <= *q && *q <= '9')
+				{
+						int value = 0;
+						for (; q != end && '0' <= *q && *q <= '9'; ++q)
+						{
+								value = 10 * value + (*q - '0');
+						}
 						
-          int s = _solMap[v_i];
-          assert(s != -1);
-          int t = _solMap[v_j];
-          assert(t != -1);
-          
-          if (s == t) continue;
-          
-          IntPair st = std::make_pair(s, t);
+						if (value == 0)
+						{
+								if (q != end && *q == ':')
+								{
+										int multiplicity = 0;
+										for (++q; q != end && '0' <= *q && *q <= '9'; ++q)
+										{
+												multiplicity = 10 * multiplicity + (*q - '0');
+										}
+										count = std::max(multiplicity, 1);
+								}
+								
+								// the rest of the line is not a literal
+								const char* newline = static_cast<const char*>(memchr(q, '\n', end - q));
+								return newline != nullptr ? newline + 1 : end;
+						}
 						
-          if (_sampledHostMap[v_j].count(t) == 0)
-          {
-            ++lambda;
-          }
+						literals.push_back(negative ? -value : value);
+						p = q;
+				}
 				
-				  if (currTransmissionCount.count(st) == 0)
-					{
-							currTransmissionCount[st] = 0;
-					}
-				  ++currTransmissionCount[st];
+				// skip the rest of the token
+				while (p != end && *p != ' ' && *p != '\t' && *p != '\n')
+				{
+						++p;
+				}
+		}
+		
+		return p == end ? end : p + 1;
+}
+
+void UnigenParser::addSample(IntNodeMap& solMap, const IntVector& literals, int count, SolutionStats& stats)
+{
+		const int solIdx = stats.nrSolutions++;
+		
+		// a solution is identified by its true vertex variables
+		IntVector assignment;
+		for (int lit : literals)
+		{
+				if (lit > 0 && lit <= _numVar)
+				{
+						assignment.push_back(lit);
+				}
+		}
+		std::sort(assignment.begin(), assignment.end());
+		
+		auto it = stats.index.find(assignment);
+		if (it != stats.index.end())
+		{
+				if (it->second >= 0)
+				{
+						stats.multiplicity[it->second] += count;
+				}
+				else if (it->second == -2)
+				{
+						stats.nrUnlabeled += count;
+				}
+				return;
+		}
+		
+		initSolution(solMap);
+		for (int lit : assignment)
+		{
+				assignLiteral(solMap, lit);
+		}
+		
+		// a sample of another formula may leave vertices unlabeled
+		for (NodeIt vi(_T.tree()); vi != lemon::INVALID; ++vi)
+		{
+				if (solMap[vi] == -1)
+				{
+						stats.nrUnlabeled += count;
+						stats.index.emplace(std::move(assignment), -2);
+						return;
+				}
+		}
+		
+		const int position = stats.solIdx.size();
+		addSolution(solMap, solIdx, count, stats);
+		stats.index.emplace(std::move(assignment), stats.solIdx.size() > position ? position : -1);
+}
+
+void UnigenParser::parseSolution(const StringVector& s, int solIdx)
+{
+		// the literals of the vertex variables, other literals are ignored
+		IntVector literals;
+		for (const std::string& varId : s)
+		{
+				if (varId.empty())
+				{
+						continue;
+				}
+				else if (varId == "0")
+				{
+						break;
+				}
 				
-				  ++mu;
-        }
+				if (varId.at(0) != '-')
+				{
+						literals.push_back(std::stoi(varId));
+				}
+		}
+		
+		SolutionStats stats;
+		stats.nrSolutions = solIdx;
+		addSample(_solMap, literals, 1, stats);
+		appendStats(stats);
+}
+
+void UnigenParser::initSolution(IntNodeMap& solMap) const
+{
+		const Digraph& G = _T.tree();
+		
+		for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+		{
+				if (lemon::countOutArcs(G, vi) == 0)
+				{
+						solMap[vi] = _T.getHostLabel(vi);
+				}
+				else
+				{
+						solMap[vi] = -1;
+				}
+		}
+		
+		for (const VarMap::Entry& label : _fixedLabels)
+		{
+				if (label.node >= 0 && _nodeByIndex[label.node] != lemon::INVALID)
+				{
+						solMap[_nodeByIndex[label.node]] = label.host >= 0 ? _hostByIndex[label.host] : -1;
+				}
+		}
+}
+
+void UnigenParser::addSolution(const IntNodeMap& solMap, int solIdx, int count, SolutionStats& stats)
+{
+		const Digraph& G = _T.tree();
+      
+    // we have a solution now, append a transmission for every arc
+    // between hosts, then merge those of the same pair of hosts
+		const size_t first = stats.transmissions.size();
+    int lambda = 0;
+    for (ArcIt a_ij(G); a_ij != lemon::INVALID; ++a_ij)
+    {
+      Node v_i = G.source(a_ij);
+      Node v_j = G.target(a_ij);
 				
-				int commonEdges = 0;
-				// compute number of common edges
-				for (ArcIt est(C); est != lemon::INVALID; ++est)
+      int s = solMap[v_i];
+      assert(s != -1);
+      int t = solMap[v_j];
+      assert(t != -1);
+      
+      if (s == t) continue;
+      
+      if (!_sampledHostMap[v_j][t])
+      {
+        ++lambda;
+      }
+		
+		  Transmission transmission = {s, t, 1};
+		  stats.transmissions.push_back(transmission);
+    }
+		
+		const int mu = stats.transmissions.size() - first;
+		if (mu > _muMax)
+		{
+				stats.transmissions.resize(first);
+				return;
+		}
+		
+		std::sort(stats.transmissions.begin() + first, stats.transmissions.end(),
+							[](const Transmission& a, const Transmission& b) { return a.s < b.s || (a.s == b.s && a.t < b.t); });
+		
+		size_t last = first;
+		int maxBottleneckSize = 0;
+		for (size_t i = first; i < stats.transmissions.size(); ++i)
+		{
+				const Transmission& transmission = stats.transmissions[i];
+				if (last > first && stats.transmissions[last - 1].s == transmission.s && stats.transmissions[last - 1].t == transmission.t)
 				{
-						int sIndex = _T.getContactIndex(C.source(est));
-						int tIndex = _T.getContactIndex(C.target(est));
-						
-						IntPair stContact = std::make_pair(sIndex, tIndex);
-						
-						if (currTransmissionCount.count(stContact) > 0)
+						++stats.transmissions[last - 1].count;
+				}
+				else
+				{
+						stats.transmissions[last++] = transmission;
+				}
+				maxBottleneckSize = std::max(maxBottleneckSize, stats.transmissions[last - 1].count);
+		}
+		stats.transmissions.resize(last);
+		stats.transmissionEnd.push_back(last);
+		
+		const Transmission* begin = stats.transmissions.data() + first;
+		const Transmission* end = stats.transmissions.data() + last;
+		
+    stats.transmissionNumber.push_back(mu);
+    stats.solIdx.push_back(solIdx);
+    stats.multiplicity.push_back(count);
+    stats.maxBottleneckSize.push_back(maxBottleneckSize);
+    stats.unsampledLineages.push_back(lambda);
+    stats.unsampledStrains.push_back(getNumUnsampledStrains(solMap));
+    stats.commonEdges.push_back(getNumCommonEdges(begin, end));
+    stats.weightedDist.push_back(getDistanceFromContact(begin, end));
+}
+
+void UnigenParser::appendStats(SolutionStats& stats)
+{
+		if (_streamTT != nullptr)
+		{
+				writeTransTrees(*_streamTT, stats);
+				if (_streamS != nullptr)
+				{
+						writeSummaryRows(*_streamS, stats, _computeDist);
+				}
+				_stats.nrWritten += stats.solIdx.size();
+		}
+		else
+		{
+				// the solutions in order of their position
+				std::vector<const IntVector*> assignments(stats.solIdx.size());
+				for (const auto& kv : stats.index)
+				{
+						if (kv.second >= 0)
 						{
-								++commonEdges;
+								assignments[kv.second] = &kv.first;
 						}
 				}
 				
-				int weightedDist = getDistanceFromContact(currTransmissionCount);
-				
-				if (mu <= _muMax)
-				{
-						_transmissionCountVector.push_back(currTransmissionCount);
-            _transmissionNumber.push_back(mu);
-            _solIdx.push_back(solIdx);
-            _maxBottleneckSize.push_back(0);
-            for (const auto& kv : currTransmissionCount)
-            {
-                _maxBottleneckSize.back() = std::max(_maxBottleneckSize.back(),
-                                                     kv.second);
-            }
-          
-          _unsampledLineages.push_back(lambda);
-						
-				  _unsampledStrains.push_back(getNumUnsampledStrains());
-						
-				  _commonEdges.push_back(commonEdges);
+				for (int i = 0; i < assignments.size(); ++i)
+				{
+						auto res = _stats.index.emplace(*assignments[i], _stats.solIdx.size());
+						if (!res.second)
+						{
+								_stats.multiplicity[res.first->second] += stats.multiplicity[i];
+								continue;
+						}
 						
-				  _weightedDist.push_back(weightedDist);
+						const size_t first = i == 0 ? 0 : stats.transmissionEnd[i - 1];
+						_stats.transmissions.insert(_stats.transmissions.end(),
+																				stats.transmissions.begin() + first,
+																				stats.transmissions.begin() + stats.transmissionEnd[i]);
+						_stats.transmissionEnd.push_back(_stats.transmissions.size());
+						_stats.solIdx.push_back(stats.solIdx[i]);
+						_stats.multiplicity.push_back(stats.multiplicity[i]);
+						_stats.transmissionNumber.push_back(stats.transmissionNumber[i]);
+						_stats.maxBottleneckSize.push_back(stats.maxBottleneckSize[i]);
+						_stats.unsampledStrains.push_back(stats.unsampledStrains[i]);
+						_stats.unsampledLineages.push_back(stats.unsampledLineages[i]);
+						_stats.commonEdges.push_back(stats.commonEdges[i]);
+						_stats.weightedDist.push_back(stats.weightedDist[i]);
 				}
-        ++solIdx;
 		}
+		
+		_stats.nrUnlabeled += stats.nrUnlabeled;
+		
+		// the solutions that follow keep their numbering
+		const int nrSolutions = stats.nrSolutions;
+		stats = SolutionStats();
+		stats.nrSolutions = nrSolutions;
 }
 
 void UnigenParser::writeSummaryStats(std::ostream& out) const
 {
-  out << "solIdx" << "\t" << "transmissions" << "\t" << "maxBottleneckSize" << "\t" << "unsampledLineages" << "\t" << "unsampledStrains" << "\t" << "numCommonEdges" << std::endl;
-  
-  const int nrSols = _solIdx.size();
-  for (int idx = 0; idx < nrSols; ++idx)
+  writeSummaryHeader(out, false);
+  writeSummaryRows(out, _stats, false);
+}
+
+void UnigenParser::writeSummaryStatsWithDist(std::ostream& out) const
+{
+  writeSummaryHeader(out, true);
+  writeSummaryRows(out, _stats, true);
+}
+
+bool UnigenParser::writeLabeledPtrees(const std::string& prefix)
+{
+		for (const auto& kv : _stats.index)
+		{
+				const int idx = kv.second;
+				if (idx < 0)
+				{
+						continue;
+				}
+				
+				initSolution(_solMap);
+				for (int lit : kv.first)
+				{
+						assignLiteral(_solMap, lit);
+				}
+				
+				const std::string filename = prefix + "idx" + std::to_string(idx) + "_count" + std::to_string(_stats.multiplicity[idx]) + ".out";
+				std::ofstream out(filename.c_str());
+				if (!out.good())
+				{
+						std::cerr << "Error: failed opening '" << filename << "' for writing" << std::endl;
+						return false;
+				}
+				_T.writePtree(out, _solMap);
+		}
+		
+		return true;
+}
+
+void UnigenParser::writeSummaryHeader(std::ostream& out, bool withDist) const
+{
+  out << "solIdx" << "\t" << "transmissions" << "\t" << "maxBottleneckSize" << "\t" << "unsampledLineages" << "\t" << "unsampledStrains" << "\t" << "numCommonEdges";
+  if (withDist)
   {
-    out << _solIdx[idx] << "\t" << _transmissionNumber[idx] << "\t" << _maxBottleneckSize[idx] << "\t" << _unsampledLineages[idx] << "\t" << _unsampledStrains[idx] << "\t" << _commonEdges[idx] << std::endl;
+    out << "\t" << "weightedDist";
   }
+  out << "\t" << "count" << '\n';
 }
 
-void UnigenParser::writeSummaryStatsWithDist(std::ostream& out) const
+void UnigenParser::writeSummaryRows(std::ostream& out, const SolutionStats& stats, bool withDist) const
 {
-  out << "solIdx" << "\t" << "transmissions" << "\t" << "maxBottleneckSize" << "\t" << "unsampledLineages" << "\t" << "unsampledStrains" << "\t" << "numCommonEdges" << "\t" << "weightedDist" << std::endl;
-  
-  const int nrSols = _solIdx.size();
+  const int nrSols = stats.solIdx.size();
   for (int idx = 0; idx < nrSols; ++idx)
-	{
-			out << _solIdx[idx] << "\t" << _transmissionNumber[idx] << "\t" << _maxBottleneckSize[idx] << "\t" << _unsampledLineages[idx] << "\t" << _unsampledStrains[idx] << "\t" << _commonEdges[idx] << "\t" << _weightedDist[idx] << std::endl;
-	}
+  {
+    out << stats.solIdx[idx] << "\t" << stats.transmissionNumber[idx] << "\t" << stats.maxBottleneckSize[idx] << "\t" << stats.unsampledLineages[idx] << "\t" << stats.unsampledStrains[idx] << "\t" << stats.commonEdges[idx];
+    if (withDist)
+    {
+      out << "\t" << stats.weightedDist[idx];
+    }
+    out << "\t" << stats.multiplicity[idx] << '\n';
+  }
 }
 
 bool UnigenParser::isAncester(const Digraph& T, Node u, Node v)
@@ -298,68 +866,70 @@ bool UnigenParser::isAncester(const Digraph& T, Node u, Node v)
 }
 
 int UnigenParser::getNumUnsampledStrains()
+{
+		return getNumUnsampledStrains(_solMap);
+}
+
+int UnigenParser::getNumUnsampledStrains(const IntNodeMap& solMap)
 {
 		const Digraph& G = _T.tree();
-		std::vector<NodeSet> leafSetperHost(_T.getNrHost());
 		
+		// a node is unsampled if no leaf below it has its host, which
+		// _sampledHostMap gives without visiting the subtree
+		int gamma = 0;
 		for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
 		{
-				if (lemon::countOutArcs(G, vi) == 0)
+				if (!_sampledHostMap[vi][solMap[vi]])
 				{
-						// is leaf
-						leafSetperHost[_solMap[vi]].insert(vi);
+						++gamma;
 				}
 		}
 		
-		int gamma = 0;
-		
-		for (NodeIt vi(G); vi != lemon::INVALID; ++vi)
+		return gamma;
+}
+
+int UnigenParser::getNumCommonEdges(const Transmission* first, const Transmission* last) const
+{
+		// both lists are sorted by host pair, so they are merged
+		int commonEdges = 0;
+		for (const Transmission& arc : _contactArcs)
 		{
-				bool isUnsampled = true;
-				
-				for (Node leaf : leafSetperHost[_solMap[vi]])
+				while (first != last && (first->s < arc.s || (first->s == arc.s && first->t < arc.t)))
 				{
-						if (isAncester(G, vi, leaf))
-						{
-								isUnsampled = false;
-								break;
-						}
+						++first;
 				}
 				
-				if (isUnsampled)
+				if (first != last && first->s == arc.s && first->t == arc.t)
 				{
-						++gamma;
+						++commonEdges;
 				}
 		}
 		
-		return gamma;
+		return commonEdges;
 }
 
-int UnigenParser::getDistanceFromContact(IntPairToIntMap currTransmissionCount)
+int UnigenParser::getDistanceFromContact(const Transmission* first, const Transmission* last) const
 {
-		const Digraph& C = _T.contactMap();
-		int countContact = 0, countTransmission = 0;
-		int countIntersect = 0;
+		int countTransmission = 0;
+		for (const Transmission* transmission = first; transmission != last; ++transmission)
+		{
+				countTransmission += transmission->count;
+		}
 		
-		for (ArcIt est(C); est != lemon::INVALID; ++est)
+		// both lists are sorted by host pair, so they are merged
+		int countIntersect = 0;
+		for (const Transmission& arc : _contactArcs)
 		{
-				int sIndex = _T.getContactIndex(C.source(est));
-				int tIndex = _T.getContactIndex(C.target(est));
-				
-				IntPair stContact = std::make_pair(sIndex, tIndex);
-				
-				if (currTransmissionCount.count(stContact) > 0)
+				while (first != last && (first->s < arc.s || (first->s == arc.s && first->t < arc.t)))
 				{
-						countIntersect += std::min(currTransmissionCount[stContact], _T.getContactNumStrains(est));
+						++first;
 				}
 				
-				countContact += _T.getContactNumStrains(est);
-		}
-		
-		for (const auto& kv : currTransmissionCount)
-		{
-				countTransmission += kv.second;
+				if (first != last && first->s == arc.s && first->t == arc.t)
+				{
+						countIntersect += std::min(first->count, arc.count);
+				}
 		}
 		
-		return countContact + countTransmission - 2*countIntersect;
+		return _nrContactStrains + countTransmission - 2*countIntersect;
 }
@@ -7,11 +7,21 @@
 
 #include "utils.h"
 #include "basetree.h"
+#include "varmap.h"
 #include <fstream>
+#include <memory>
 
 class UnigenParser
 {
 public:
+		/// number of transmissions from host s to host t
+		struct Transmission
+		{
+				int s;
+				int t;
+				int count;
+		};
+		
 		/// Default constructor
 		UnigenParser();
 		
@@ -23,49 +33,181 @@ public:
 		
 		bool readVarFile(std::istream& in);
 		
+		/// read a binary variable map written by dimacs -m
+		bool readVarMap(const std::string& filename);
+		
 		void parseUnigen(std::istream& in);
+		
+		/// parse the samples of a file, which is memory-mapped and split into
+		/// line-aligned chunks that are parsed by nrThreads threads; a file that
+		/// can not be mapped, such as a pipe, is parsed sequentially
+		bool parseUnigen(const std::string& filename, int nrThreads);
+		
+		/// parse the samples of the independent components of a formula,
+		/// combining the i-th sample of every component
+		void parseUnigen(const std::vector<std::istream*>& in);
+		
+		/// parse a solution given by its literals
+		void parseSolution(const StringVector& s, int solIdx);
+		
+		/// write the transmission trees and summary statistics (if outS is not
+		/// nullptr) of every part of the samples as soon as it is parsed,
+		/// instead of keeping them for writeTransTrees and writeSummaryStats
+		void setStreaming(std::ostream& outTT, std::ostream* outS);
+		
+		/// write the number of streamed transmission trees in their header
+		void finishStreaming();
+		
+		/// set the minimum size in bytes of the chunks of a mapped sample file
+		/// (default: 1 MB), smaller chunks split small files for testing
+		void setMinChunkSize(size_t minChunkSize)
+		{
+				_minChunkSize = std::max<size_t>(minChunkSize, 1);
+		}
+		
+		/// Return number of samples that left a vertex unlabeled and were skipped
+		int getNrUnlabeledSamples() const
+		{
+				return _stats.nrUnlabeled;
+		}
   
     void writeTransTrees(std::ostream& out) const;
   
     void writeSummaryStats(std::ostream& out) const;
 
+		/// write the ptree labeled by every kept solution to
+		/// <prefix>idx<position>_count<multiplicity>.out
+		bool writeLabeledPtrees(const std::string& prefix);
+
 		void writeSummaryStatsWithDist(std::ostream& out) const;
 		
 		bool isAncester(const Digraph& T, Node u, Node v);
 		
 		int getNumUnsampledStrains();
 		
-		int getDistanceFromContact(IntPairToIntMap currTransmissionCount);
+		int getNumUnsampledStrains(const IntNodeMap& solMap);
+		
+		/// Return distance between the contact map and the transmissions
+		/// [first, last), which are sorted by host pair
+		int getDistanceFromContact(const Transmission* first, const Transmission* last) const;
 		  
 private:
   void initSampledHosts(Node v);
   
+  void initContactArcs();
+  
 protected:
+		/// statistics of the solutions of a part of the samples
+		struct SolutionStats
+		{
+				/// number of parsed solutions, including those above muMax
+				int nrSolutions = 0;
+				/// number of solutions written by streaming
+				int nrWritten = 0;
+				/// number of samples that leave a vertex unlabeled
+				int nrUnlabeled = 0;
+				/// positive vertex literals of every distinct solution to the
+				/// position of its statistics, -1 if it is above muMax and -2
+				/// if it leaves a vertex unlabeled
+				IntVectorToIntHashMap index;
+				/// number of times every distinct solution was sampled
+				IntVector multiplicity;
+				std::vector<Transmission> transmissions;
+				std::vector<size_t> transmissionEnd;
+				IntVector solIdx;
+				IntVector transmissionNumber;
+				IntVector maxBottleneckSize;
+				IntVector unsampledStrains;
+				IntVector unsampledLineages;
+				IntVector commonEdges;
+				IntVector weightedDist;
+		};
+		
+		/// scan the literals of the line starting at p up to the 0 ending the
+		/// solution and the multiplicity following it as "0:count" (1 if
+		/// there is none), returns the start of the next line
+		static const char* scanLiterals(const char* p, const char* end, IntVector& literals, int& count);
+		
+		/// add a solution sampled count times, its statistics are only
+		/// computed if it was not parsed before
+		void addSample(IntNodeMap& solMap, const IntVector& literals, int count, SolutionStats& stats);
+		
+		/// label the leaves and the labels fixed by preprocessing
+		void initSolution(IntNodeMap& solMap) const;
+		
+		/// label a node if lit is a true vertex variable
+		void assignLiteral(IntNodeMap& solMap, int lit) const
+		{
+				if (lit > 0 && lit <= _numVar)
+				{
+						const VarMap::Entry& label = _varLabels[lit - 1];
+						if (label.node >= 0 && _nodeByIndex[label.node] != lemon::INVALID)
+						{
+								solMap[_nodeByIndex[label.node]] = label.host >= 0 ? _hostByIndex[label.host] : -1;
+						}
+				}
+		}
+		
+		/// Return number of contact map arcs among the transmissions
+		/// [first, last), which are sorted by host pair
+		int getNumCommonEdges(const Transmission* first, const Transmission* last) const;
+		
+		/// write the header of the summary statistics
+		void writeSummaryHeader(std::ostream& out, bool withDist) const;
+		
+		/// write the summary statistics of the solutions of stats
+		void writeSummaryRows(std::ostream& out, const SolutionStats& stats, bool withDist) const;
+		
+		/// write the transmission trees of the solutions of stats
+		void writeTransTrees(std::ostream& out, const SolutionStats& stats) const;
+		
+		/// add the statistics of a labeling
+		void addSolution(const IntNodeMap& solMap, int solIdx, int count, SolutionStats& stats);
+		
+		/// append statistics to those of the parsed solutions, adding the
+		/// multiplicity of solutions parsed before, or write them when streaming
+		void appendStats(SolutionStats& stats);
+
     /// Contact map and ptree
 		const BaseTree& _T;
 		IntNodeMap _solMap;
   
-    Digraph::NodeMap<IntSet> _sampledHostMap;
-  
-    /// Variable index to <v,s> pair
-		StringPairVector _nodeHostPair;
+    /// Hosts of the leaves in the subtree of every node, by host index
+    BoolVectorNodeMap _sampledHostMap;
   
-    /// Number of transmitted strains between every pair of hosts
-    std::vector<std::map<std::pair<int, int>, int>> _transmissionCountVector;
+    /// Variable index to <v,s> pair, as indices of _nodeByIndex and _hostByIndex
+		const VarMap::Entry* _varLabels;
+		
+		/// <v,s> pairs of a text variable list
+		std::vector<VarMap::Entry> _textVarLabels;
+		
+		/// mapped binary variable map
+		VarMap _varMap;
+		
+		/// <v,s> pairs fixed by preprocessing
+		std::vector<VarMap::Entry> _fixedLabels;
+		
+		/// nodes and host indices of the node and host indices of the variable list
+		NodeVector _nodeByIndex;
+		IntVector _hostByIndex;
   
-    IntVector _solIdx;
-
-    IntVector _transmissionNumber;
+    /// Statistics of the parsed solutions, not kept when streaming
+    SolutionStats _stats;
     
-    IntVector _maxBottleneckSize;
+    /// Contact map arcs sorted by host pair, with their number of strains
+    std::vector<Transmission> _contactArcs;
     
-    IntVector _unsampledStrains;
-		
-		IntVector _unsampledLineages;
+    /// Total number of strains of the contact map
+    int _nrContactStrains;
   
-		IntVector _commonEdges;
-		
-		IntVector _weightedDist;
+    /// Streamed transmission trees and summary statistics
+    std::ostream* _streamTT;
+    std::ostream* _streamS;
+    
+    /// Position of the number of trees in the streamed transmission trees
+    std::streampos _streamHeaderPos;
+    /// Minimum size in bytes of the chunks of a mapped sample file
+    size_t _minChunkSize;
 		
     std::string _transPrefix;
   
@@ -9,6 +9,7 @@
 #include "unigenparser.h"
 #include "basetree.h"
 #include <fstream>
+#include <thread>
 #include <lemon/arg_parser.h>
 
 int main(int argc, char** argv)
@@ -19,26 +20,40 @@ int main(int argc, char** argv)
     typedef Digraph::ArcMap<int> IntArcMap;
 		int muMax = std::numeric_limits<int>::max();
 		
-		std::string ptree_filename, host_filename, varlist_filename, unigen_filename, trans_prefix;
+		std::string ptree_filename, host_filename, varlist_filename, trans_prefix;
     std::string summary_filename;
 		std::string contactmap_filename;
 		std::string ttree_filename;
+		std::string ptree_prefix;
+		int nrThreads = std::max(1u, std::thread::hardware_concurrency());
+		bool stream = false;
+		int minChunkSize = 1 << 20;
 		
 		lemon::ArgParser ap(argc, argv);
     ap.refOption("S", "summary file name", summary_filename);
 		ap.refOption("muMax", "maximum value of mu : (default: max<int>)", muMax);
 		ap.refOption("c", "contact map file : (default: empty)", contactmap_filename);
 		ap.refOption("t", "transmission tree file: (default: empty)", ttree_filename);
+		ap.refOption("j", "number of threads parsing a single unigen file : (default: number of cores)", nrThreads);
+		ap.refOption("P", "prefix of a labeled ptree file per distinct solution : (default: empty)", ptree_prefix);
+		ap.refOption("chunk", "minimum size in bytes of the chunks of a single unigen file, for testing : (default: 1048576)", minChunkSize);
+		ap.refOption("stream", "write the output while parsing, without keeping all solutions; a solution sampled in several parts of the samples is written once per part : (default: false)", stream);
 		ap.other("<host>");
 		ap.other("<ptree>");
-		ap.other("<varlist>");
-		ap.other("<unigen_file>");
+		ap.other("<varlist>", "variable list or binary variable map (dimacs -m)");
+		ap.other("<unigen_file>", "one file per component of a formula split by dimacs -d");
 		ap.other("<output_prefix>");
 		ap.parse();
 
-		if (ap.files().size() != 5)
+		if (ap.files().size() < 5)
 		{
-				std::cerr << "Error1: expected <host> <ptree> <varlist> <unigen_file> <output_prefix>" << std::endl;
+				std::cerr << "Error1: expected <host> <ptree> <varlist> <unigen_file> [<unigen_file> ...] <output_prefix>" << std::endl;
+				return 1;
+		}
+		
+		if (stream && !ptree_prefix.empty())
+		{
+				std::cerr << "Error1: -P cannot be combined with -stream, which does not keep the solutions" << std::endl;
 				return 1;
 		}
 		
@@ -50,8 +65,8 @@ int main(int argc, char** argv)
 		host_filename = ap.files()[0];
 		ptree_filename = ap.files()[1];
 		varlist_filename = ap.files()[2];
-		unigen_filename = ap.files()[3];
-		trans_prefix = ap.files()[4];
+		StringVector unigen_filenames(ap.files().begin() + 3, ap.files().end() - 1);
+		trans_prefix = ap.files().back();
 		
 		std::ifstream host_file(host_filename.c_str());
 		if (!host_file.good())
@@ -128,6 +143,7 @@ int main(int argc, char** argv)
 		}
 
 		UnigenParser parser(B, trans_prefix, muMax, computeDist);
+		parser.setMinChunkSize(std::max(minChunkSize, 1));
 		
 		std::ifstream varlist_file(varlist_filename.c_str());
 		if (!varlist_file.good())
@@ -136,26 +152,91 @@ int main(int argc, char** argv)
 				return 1;
 		}
 		
-		parser.readVarFile(varlist_file);
+		// a binary variable map written by dimacs -m, or a text variable list
+		if (VarMap::isVarMap(varlist_filename))
+		{
+				if (!parser.readVarMap(varlist_filename))
+				{
+						return 1;
+				}
+		}
+		else
+		{
+				parser.readVarFile(varlist_file);
+		}
 		varlist_file.close();
 		
-		std::ifstream unigen_file(unigen_filename.c_str());
-		if (!unigen_file.good())
+		// when streaming, the output is written while the samples are parsed
+		std::ofstream outTT;
+		std::ofstream outS;
+		if (stream)
 		{
-				std::cerr << "Error8: failed opening '" << unigen_filename << "' for reading" << std::endl;
+				outTT.open(trans_prefix.c_str());
+				if (!summary_filename.empty())
+				{
+						outS.open(summary_filename.c_str());
+				}
+				parser.setStreaming(outTT, summary_filename.empty() ? nullptr : &outS);
+		}
+		
+		if (unigen_filenames.size() == 1)
+		{
+				// a single file is memory-mapped and parsed in parallel
+				if (!parser.parseUnigen(unigen_filenames[0], nrThreads))
+				{
+						std::cerr << "Error8: failed opening '" << unigen_filenames[0] << "' for reading" << std::endl;
+						return 1;
+				}
+		}
+		else
+		{
+				std::vector<std::ifstream> unigen_files(unigen_filenames.size());
+				std::vector<std::istream*> unigen_streams;
+				for (int k = 0; k < unigen_filenames.size(); ++k)
+				{
+						unigen_files[k].open(unigen_filenames[k].c_str());
+						if (!unigen_files[k].good())
+						{
+								std::cerr << "Error8: failed opening '" << unigen_filenames[k] << "' for reading" << std::endl;
+								return 1;
+						}
+						unigen_streams.push_back(&unigen_files[k]);
+				}
+				
+				parser.parseUnigen(unigen_streams);
+				
+				for (std::ifstream& unigen_file : unigen_files)
+				{
+						unigen_file.close();
+				}
+		}
+  
+		if (parser.getNrUnlabeledSamples() > 0)
+		{
+				std::cerr << "Error9: " << parser.getNrUnlabeledSamples() << " samples leave vertices unlabeled, they do not match '" << varlist_filename << "'" << std::endl;
 				return 1;
 		}
 		
-		parser.parseUnigen(unigen_file);
-		unigen_file.close();
+		if (stream)
+		{
+				parser.finishStreaming();
+				outTT.close();
+				outS.close();
+				return 0;
+		}
   
-    std::ofstream outTT(trans_prefix);
+		if (!ptree_prefix.empty() && !parser.writeLabeledPtrees(ptree_prefix))
+		{
+				return 1;
+		}
+		
+    outTT.open(trans_prefix.c_str());
     parser.writeTransTrees(outTT);
     outTT.close();
   
 		if (!summary_filename.empty())
 		{
-				std::ofstream outS(summary_filename.c_str());
+				outS.open(summary_filename.c_str());
 				if (computeDist)
 				{
 						parser.writeSummaryStatsWithDist(outS);
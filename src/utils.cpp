@@ -12,6 +12,18 @@ lemon::Tolerance<double> g_tol(1e-4);
 
 std::mt19937 g_rng(0);
 
+size_t IntVectorHash::operator()(const IntVector& v) const
+{
+    // FNV-1a over the entries
+    uint64_t h = 14695981039346656037ULL;
+    for (int x : v)
+    {
+        h ^= static_cast<uint32_t>(x);
+        h *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(h);
+}
+
 std::istream& getline(std::istream& is, std::string& t)
 {
     // source: http://stackoverflow.com/questions/6089231/getting-std-ifstream-to-handle-lf-cr-and-crlf
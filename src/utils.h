@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <list>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <vector>
 #include <boost/algorithm/string.hpp>
@@ -117,6 +118,15 @@ typedef std::vector<StringPair> StringPairVector;
 typedef std::map<std::string, IntPair> StringToIntPairMap;
 typedef std::map<std::pair<int, int>, int> IntPairToIntMap;
 
+/// Hash of an integer vector
+struct IntVectorHash
+{
+    size_t operator()(const IntVector& v) const;
+};
+
+typedef std::unordered_map<IntVector, uint64_t, IntVectorHash> IntVectorToUInt64HashMap;
+typedef std::unordered_map<IntVector, int, IntVectorHash> IntVectorToIntHashMap;
+
 typedef std::list<Arc> ArcList;
 typedef ArcList::const_iterator ArcListIt;
 typedef ArcList::iterator ArcListNonConstIt;
@@ -0,0 +1,129 @@
+/*
+ * varmap.cpp
+ *
+ *  Created on: 19-oct-2026
+ *      Author: P. Sashittal
+ */
+
+#include "varmap.h"
+#include <fstream>
+#include <cstring>
+
+static const char varMapMagic[8] = {'T', 'i', 'T', 'U', 'S', 'V', 'M', '\0'};
+static const uint32_t varMapVersion = 1;
+
+VarMap::VarMap()
+    : _file()
+    , _header(nullptr)
+    , _vars(nullptr)
+    , _nodeNames()
+    , _hostNames()
+{
+}
+
+VarMap::~VarMap()
+{
+    close();
+}
+
+bool VarMap::write(const std::string& filename,
+                   const std::vector<Entry>& vars,
+                   const std::vector<Entry>& fixed,
+                   const StringVector& nodeNames,
+                   const StringVector& hostNames)
+{
+    std::ofstream out(filename.c_str(), std::ios::binary);
+    if (!out.good())
+    {
+        std::cerr << "error: failed opening '" << filename << "' for writing" << std::endl;
+        return false;
+    }
+
+    Header header;
+    std::memcpy(header.magic, varMapMagic, sizeof(varMapMagic));
+    header.version = varMapVersion;
+    header.nrVars = vars.size();
+    header.nrFixed = fixed.size();
+    header.nrNodes = nodeNames.size();
+    header.nrHosts = hostNames.size();
+    header.namesSize = 0;
+    for (const std::string& name : nodeNames)
+    {
+        header.namesSize += name.size() + 1;
+    }
+    for (const std::string& name : hostNames)
+    {
+        header.namesSize += name.size() + 1;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(vars.data()), vars.size() * sizeof(Entry));
+    out.write(reinterpret_cast<const char*>(fixed.data()), fixed.size() * sizeof(Entry));
+    for (const std::string& name : nodeNames)
+    {
+        out.write(name.c_str(), name.size() + 1);
+    }
+    for (const std::string& name : hostNames)
+    {
+        out.write(name.c_str(), name.size() + 1);
+    }
+
+    out.close();
+    return out.good();
+}
+
+bool VarMap::isVarMap(const std::string& filename)
+{
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    char magic[8];
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, varMapMagic, sizeof(magic)) == 0;
+}
+
+bool VarMap::open(const std::string& filename)
+{
+    close();
+
+    if (!_file.open(filename) || _file.size() < sizeof(Header))
+    {
+        close();
+        return false;
+    }
+
+    _header = reinterpret_cast<const Header*>(_file.data());
+    const size_t nrEntries = static_cast<size_t>(_header->nrVars) + _header->nrFixed;
+    if (std::memcmp(_header->magic, varMapMagic, sizeof(varMapMagic)) != 0
+        || _header->version != varMapVersion
+        || _file.size() != sizeof(Header) + nrEntries * sizeof(Entry) + _header->namesSize)
+    {
+        close();
+        return false;
+    }
+    _vars = reinterpret_cast<const Entry*>(_header + 1);
+
+    // the names are only needed to match the indices with those of the
+    // tree that is read, they are few compared to the variables
+    const char* name = reinterpret_cast<const char*>(_vars + nrEntries);
+    const char* end = name + _header->namesSize;
+    for (uint32_t i = 0; i < _header->nrNodes + _header->nrHosts; ++i)
+    {
+        const char* nameEnd = static_cast<const char*>(memchr(name, '\0', end - name));
+        if (nameEnd == nullptr)
+        {
+            close();
+            return false;
+        }
+        (i < _header->nrNodes ? _nodeNames : _hostNames).push_back(std::string(name, nameEnd));
+        name = nameEnd + 1;
+    }
+
+    return true;
+}
+
+void VarMap::close()
+{
+    _file.close();
+    _header = nullptr;
+    _vars = nullptr;
+    _nodeNames.clear();
+    _hostNames.clear();
+}
@@ -0,0 +1,120 @@
+/*
+ * varmap.h
+ *
+ *  Created on: 19-oct-2026
+ *      Author: P. Sashittal
+ */
+
+#ifndef VARMAP_H
+#define VARMAP_H
+
+#include "utils.h"
+#include "mappedfile.h"
+
+/// This class reads and writes the binary variable map of a DIMACS formula.
+/// The file is a fixed size header, the (node index, host index) entry of
+/// every vertex variable (variable id - 1 is the position of its entry)
+/// followed by the entries of the labels fixed by preprocessing, and the
+/// node and host names by index. It is memory-mapped, so opening it does
+/// not depend on its size and an entry is found by array index.
+class VarMap
+{
+public:
+    /// vertex label
+    struct Entry
+    {
+        int32_t node;
+        int32_t host;
+    };
+
+    /// Default constructor
+    VarMap();
+
+    /// Destructor
+    ~VarMap();
+
+    /// write a variable map
+    ///
+    /// @param vars Labels of the variables 1, 2, ...
+    /// @param fixed Labels fixed to true by preprocessing
+    /// @param nodeNames Node names by node index
+    /// @param hostNames Host names by host index
+    static bool write(const std::string& filename,
+                      const std::vector<Entry>& vars,
+                      const std::vector<Entry>& fixed,
+                      const StringVector& nodeNames,
+                      const StringVector& hostNames);
+
+    /// Return whether a file starts like a variable map
+    static bool isVarMap(const std::string& filename);
+
+    /// map a variable map file, returns false if it is not one
+    bool open(const std::string& filename);
+
+    /// Return number of variables
+    int getNrVars() const
+    {
+        return _header ? _header->nrVars : 0;
+    }
+
+    /// Return labels of the variables 1, 2, ...
+    const Entry* getVars() const
+    {
+        return _vars;
+    }
+
+    /// Return number of labels fixed by preprocessing
+    int getNrFixed() const
+    {
+        return _header ? _header->nrFixed : 0;
+    }
+
+    /// Return labels fixed by preprocessing
+    const Entry* getFixed() const
+    {
+        return _vars + getNrVars();
+    }
+
+    /// Return node names by node index
+    const StringVector& getNodeNames() const
+    {
+        return _nodeNames;
+    }
+
+    /// Return host names by host index
+    const StringVector& getHostNames() const
+    {
+        return _hostNames;
+    }
+
+private:
+    VarMap(const VarMap&) = delete;
+    VarMap& operator=(const VarMap&) = delete;
+
+    /// file header
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t nrVars;
+        uint32_t nrFixed;
+        uint32_t nrNodes;
+        uint32_t nrHosts;
+        uint32_t namesSize;
+    };
+
+    /// unmap the file
+    void close();
+
+    /// mapped file
+    MappedFile _file;
+    /// header of the mapped file
+    const Header* _header;
+    /// entries of the mapped file
+    const Entry* _vars;
+    /// node and host names
+    StringVector _nodeNames;
+    StringVector _hostNames;
+};
+
+#endif // VARMAP_H